@@ -0,0 +1,96 @@
+#include <cstdlib>
+#include <new>
+#include <sstream>
+
+#include "bench.hpp"
+
+// allocation counting ---------------------------------------------------------
+
+namespace {
+thread_local std::size_t allocations{0};
+}  // namespace
+
+void* operator new(std::size_t size) {
+  allocations++;
+  if (auto* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+
+void* operator new(std::size_t size, std::align_val_t al) {
+  allocations++;
+  const auto align = static_cast<std::size_t>(al);
+  const auto rounded = (size + align - 1) / align * align;
+  if (auto* p = std::aligned_alloc(align, rounded == 0 ? align : rounded)) {
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+std::size_t nil::bench::thread_allocations() noexcept { return allocations; }
+
+// entry point -----------------------------------------------------------------
+
+namespace {
+
+std::vector<std::size_t> parse_list(const std::string& s) {
+  std::vector<std::size_t> out;
+  std::stringstream ss{s};
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    out.push_back(std::stoul(item));
+  }
+  return out;
+}
+
+void usage(const char* exe) {
+  std::printf(
+      "usage: %s [--filter <substr>] [--threads 1,2,4,...] [--ops <n>] "
+      "[--list]\n",
+      exe);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  nil::bench::options opts;
+  bool list_only = false;
+
+  for (int ii{1}; ii < argc; ii++) {
+    const std::string arg{argv[ii]};
+    const bool has_value = ii + 1 < argc;
+    if (arg == "--filter" && has_value) {
+      opts.filter = argv[++ii];
+    } else if (arg == "--threads" && has_value) {
+      opts.threads = parse_list(argv[++ii]);
+    } else if (arg == "--ops" && has_value) {
+      opts.ops = std::stoul(argv[++ii]);
+    } else if (arg == "--list") {
+      list_only = true;
+    } else {
+      usage(argv[0]);
+      return arg == "--help" ? 0 : 1;
+    }
+  }
+
+  if (list_only) {
+    for (const auto& [name, func] : nil::bench::suites()) {
+      std::printf("%s\n", name.c_str());
+    }
+    return 0;
+  }
+
+  nil::bench::print_header();
+  for (const auto& [name, func] : nil::bench::suites()) {
+    func(opts);
+  }
+  return 0;
+}
@@ -0,0 +1,456 @@
+#include "async/atomic.hpp"
+#include "async/atomic_rcu.hpp"
+#include "async/atomic_rw.hpp"
+#include "async/atomic_rw_scalable.hpp"
+#include "async/cache_line.hpp"
+#include "async/latest.hpp"
+#include "async/optional.hpp"
+#include "async/seqlock_atomic.hpp"
+#include "async/spin_atomic.hpp"
+#include "async/strand.hpp"
+#include "bench.hpp"
+
+using namespace nil;
+using nil::bench::payload;
+
+namespace {
+
+template <std::size_t N>
+std::string sized(const std::string& name) {
+  return name + "/" + std::to_string(N) + "B";
+}
+
+/** a poller's last seen version, one cache line per thread */
+template <class A>
+struct alignas(async::cache_line_size) last_seen {
+  typename A::version_type version{0};
+};
+
+// nil::atomic / nil::spin_atomic ---------------------------------------------
+
+template <template <class> class A, std::size_t N>
+void atomic_suite(const bench::options& opts, const std::string& prefix) {
+  using value_t = payload<N>;
+
+  for (auto threads : opts.threads) {
+    A<value_t> a;
+    bench::run(opts, sized<N>(prefix + "/peek"), threads, [&](auto, auto) {
+      bench::do_not_optimize(a.peek());
+    });
+  }
+
+  for (auto threads : opts.threads) {
+    A<value_t> a;
+    bench::run(opts, sized<N>(prefix + "/push"), threads,
+               [&](auto, auto) { a.push(value_t{}); });
+  }
+
+  for (auto threads : opts.threads) {
+    A<value_t> a;
+    bench::run(opts, sized<N>(prefix + "/apply"), threads, [&](auto, auto) {
+      a.apply([](auto& v) { v.bytes[0]++; });
+    });
+  }
+
+  for (auto read_pct : {50, 90, 99}) {
+    const auto name =
+        sized<N>(prefix + "/peek_push/r" + std::to_string(read_pct));
+    for (auto threads : opts.threads) {
+      A<value_t> a;
+      bench::run(opts, name, threads, [&](auto, auto ii) {
+        if (bench::is_read(ii, read_pct)) {
+          bench::do_not_optimize(a.peek());
+        } else {
+          a.push(value_t{});
+        }
+      });
+    }
+  }
+
+  // pollers that only copy when the data changed
+  for (auto threads : opts.threads) {
+    A<value_t> a;
+    std::vector<last_seen<A<value_t>>> last(threads);
+    bench::run(opts, sized<N>(prefix + "/peek_if_newer_push/r99"), threads,
+               [&](auto tid, auto ii) {
+                 if (bench::is_read(ii, 99)) {
+                   if (auto next = a.peek_if_newer(last[tid].version)) {
+                     last[tid].version = next->second;
+                   }
+                 } else {
+                   a.push(value_t{});
+                 }
+               });
+  }
+}
+
+// nil::seqlock_atomic ---------------------------------------------------------
+
+template <std::size_t N>
+void seqlock_atomic_suite(const bench::options& opts) {
+  using value_t = payload<N>;
+
+  for (auto threads : opts.threads) {
+    seqlock_atomic<value_t> a;
+    bench::run(opts, sized<N>("seqlock_atomic/peek"), threads,
+               [&](auto, auto) { bench::do_not_optimize(a.peek()); });
+  }
+
+  for (auto threads : opts.threads) {
+    seqlock_atomic<value_t> a;
+    bench::run(opts, sized<N>("seqlock_atomic/push"), threads,
+               [&](auto, auto) { a.push(value_t{}); });
+  }
+
+  for (auto read_pct : {50, 90, 99}) {
+    const auto name =
+        sized<N>("seqlock_atomic/peek_push/r" + std::to_string(read_pct));
+    for (auto threads : opts.threads) {
+      seqlock_atomic<value_t> a;
+      bench::run(opts, name, threads, [&](auto, auto ii) {
+        if (bench::is_read(ii, read_pct)) {
+          bench::do_not_optimize(a.peek());
+        } else {
+          a.push(value_t{});
+        }
+      });
+    }
+  }
+}
+
+// nil::atomic_rw / nil::atomic_rw_scalable -----------------------------------
+
+template <template <class> class A, std::size_t N>
+void atomic_rw_suite(const bench::options& opts, const std::string& prefix) {
+  using value_t = payload<N>;
+
+  for (auto threads : opts.threads) {
+    A<value_t> a;
+    bench::run(opts, sized<N>(prefix + "/read"), threads, [&](auto, auto) {
+      bench::do_not_optimize(a.read()->bytes[0]);
+    });
+  }
+
+  for (auto threads : opts.threads) {
+    A<value_t> a;
+    bench::run(opts, sized<N>(prefix + "/copy"), threads, [&](auto, auto) {
+      bench::do_not_optimize(a.copy());
+    });
+  }
+
+  for (auto threads : opts.threads) {
+    A<value_t> a;
+    bench::run(opts, sized<N>(prefix + "/write"), threads,
+               [&](auto, auto) { a.write()->bytes[0]++; });
+  }
+
+  for (auto read_pct : {50, 90, 99}) {
+    const auto name =
+        sized<N>(prefix + "/read_write/r" + std::to_string(read_pct));
+    for (auto threads : opts.threads) {
+      A<value_t> a;
+      bench::run(opts, name, threads, [&](auto, auto ii) {
+        if (bench::is_read(ii, read_pct)) {
+          bench::do_not_optimize(a.read()->bytes[0]);
+        } else {
+          a.write()->bytes[0]++;
+        }
+      });
+    }
+  }
+
+  // pollers that only copy when the data changed
+  for (auto threads : opts.threads) {
+    A<value_t> a;
+    std::vector<last_seen<A<value_t>>> last(threads);
+    bench::run(opts, sized<N>(prefix + "/copy_if_newer_write/r99"), threads,
+               [&](auto tid, auto ii) {
+                 if (bench::is_read(ii, 99)) {
+                   if (auto next = a.copy_if_newer(last[tid].version)) {
+                     last[tid].version = next->second;
+                   }
+                 } else {
+                   a.write()->bytes[0]++;
+                 }
+               });
+  }
+}
+
+// nil::atomic_rcu -------------------------------------------------------------
+
+template <std::size_t N>
+void atomic_rcu_suite(const bench::options& opts) {
+  using value_t = payload<N>;
+
+  for (auto threads : opts.threads) {
+    atomic_rcu<value_t> a;
+    bench::run(opts, sized<N>("atomic_rcu/read"), threads, [&](auto, auto) {
+      bench::do_not_optimize(a.read()->bytes[0]);
+    });
+  }
+
+  for (auto threads : opts.threads) {
+    atomic_rcu<value_t> a;
+    bench::run(opts, sized<N>("atomic_rcu/write"), threads,
+               [&](auto, auto) { a.write()->bytes[0]++; });
+  }
+
+  for (auto read_pct : {50, 90, 99}) {
+    const auto name =
+        sized<N>("atomic_rcu/read_write/r" + std::to_string(read_pct));
+    for (auto threads : opts.threads) {
+      atomic_rcu<value_t> a;
+      bench::run(opts, name, threads, [&](auto, auto ii) {
+        if (bench::is_read(ii, read_pct)) {
+          bench::do_not_optimize(a.read()->bytes[0]);
+        } else {
+          a.write()->bytes[0]++;
+        }
+      });
+    }
+  }
+}
+
+// nil::async::latest ----------------------------------------------------------
+
+/**
+ * thread 0 publishes, every other thread reads the latest value. Thread counts
+ * with more than @p max_readers readers are skipped
+ */
+template <class A, std::size_t N>
+void writer_readers_suite(const bench::options& opts, const std::string& prefix,
+                          std::size_t max_readers = SIZE_MAX) {
+  using value_t = payload<N>;
+
+  for (auto threads : opts.threads) {
+    if (threads - 1 > max_readers) {
+      std::printf("%-48s %7zu skipped, room for %zu readers only\n",
+                  sized<N>(prefix + "/writer_readers").c_str(), threads,
+                  max_readers);
+      continue;
+    }
+    A a;
+    bench::run(opts, sized<N>(prefix + "/writer_readers"), threads,
+               [&](auto tid, auto) {
+                 if (tid == 0) {
+                   a.push(value_t{});
+                 } else {
+                   bench::do_not_optimize(a.peek());
+                 }
+               });
+  }
+}
+
+template <std::size_t N>
+void latest_suite(const bench::options& opts) {
+  using value_t = payload<N>;
+  constexpr std::size_t max_readers = 64;
+  using latest_t = async::latest<value_t, max_readers + 2>;
+
+  for (auto threads : opts.threads) {
+    latest_t l;
+    bench::run(opts, sized<N>("latest/peek"), threads,
+               [&](auto, auto) { bench::do_not_optimize(l.peek()); });
+  }
+
+  for (auto threads : opts.threads) {
+    latest_t l;
+    bench::run(opts, sized<N>("latest/read"), threads, [&](auto, auto) {
+      bench::do_not_optimize(l.read()->bytes[0]);
+    });
+  }
+
+  // one writer per latest, so only one thread pushes. With more readers than
+  // spare buffers the writer would spin until the readers finish, forever
+  writer_readers_suite<latest_t, N>(opts, "latest", max_readers);
+  writer_readers_suite<atomic<value_t>, N>(opts, "atomic");
+}
+
+// nil::async::optional --------------------------------------------------------
+
+template <std::size_t N>
+void optional_suite(const bench::options& opts) {
+  using value_t = payload<N>;
+
+  for (auto threads : opts.threads) {
+    async::optional<value_t> o;
+    bench::run(opts, sized<N>("optional/push_pop"), threads,
+               [&](auto, auto ii) {
+                 if (ii % 2 == 0) {
+                   o.push(value_t{});
+                 } else {
+                   bench::do_not_optimize(o.pop());
+                 }
+               });
+  }
+}
+
+// copy into caller's storage -------------------------------------------------
+
+/** heap-allocated values, where returning a fresh copy allocates every time */
+void copy_into_suite(const bench::options& opts) {
+  using value_t = std::vector<double>;
+  struct alignas(async::cache_line_size) storage {
+    value_t v{value_t(128, 0.0)};
+  };
+  const value_t init(128, 1.0);
+
+  for (auto threads : opts.threads) {
+    atomic<value_t> a{init};
+    bench::run(opts, "atomic/peek/vector128", threads,
+               [&](auto, auto) { bench::do_not_optimize(a.peek()); });
+  }
+
+  for (auto threads : opts.threads) {
+    atomic<value_t> a{init};
+    std::vector<storage> out(threads);
+    bench::run(opts, "atomic/peek_into/vector128", threads,
+               [&](auto tid, auto) { a.peek_into(out[tid].v); });
+  }
+
+  for (auto threads : opts.threads) {
+    atomic_rw<value_t> a{init};
+    bench::run(opts, "atomic_rw/copy/vector128", threads,
+               [&](auto, auto) { bench::do_not_optimize(a.copy()); });
+  }
+
+  for (auto threads : opts.threads) {
+    atomic_rw<value_t> a{init};
+    std::vector<storage> out(threads);
+    bench::run(opts, "atomic_rw/copy_into/vector128", threads,
+               [&](auto tid, auto) { a.copy_into(out[tid].v); });
+  }
+}
+
+// nil::async::strand ---------------------------------------------------------
+
+/** callers that don't need the result: locking vs queueing the update */
+void strand_suite(const bench::options& opts) {
+  using value_t = payload<64>;
+
+  for (auto threads : opts.threads) {
+    atomic<value_t> a;
+    bench::run(opts, "atomic/apply_increment/64B", threads, [&](auto, auto) {
+      a.apply([](value_t& v) { v.bytes[0]++; });
+    });
+  }
+
+  for (auto threads : opts.threads) {
+    async::strand<value_t> s;
+    bench::run(opts, "strand/post_increment/64B", threads, [&](auto, auto) {
+      s.post([](value_t& v) { v.bytes[0]++; });
+    });
+  }
+}
+
+// false sharing --------------------------------------------------------------
+
+/** every thread only touches its own element of a per-thread array */
+template <class A, class Op>
+void per_thread_suite(const bench::options& opts, const std::string& name,
+                      Op op) {
+  for (auto threads : opts.threads) {
+    auto array = std::make_unique<A[]>(threads);
+    bench::run(opts, name, threads, [&](auto tid, auto) { op(array[tid]); });
+  }
+}
+
+template <class A>
+void per_thread_atomic_suite(const bench::options& opts,
+                             const std::string& name) {
+  per_thread_suite<A>(opts, name, [](auto& a) {
+    a.apply([](auto& v) { v.bytes[0]++; });
+  });
+}
+
+template <class O>
+void per_thread_optional_suite(const bench::options& opts,
+                               const std::string& name) {
+  per_thread_suite<O>(opts, name,
+                      [](auto& o) { o.push(typename O::value_type{}); });
+}
+
+template <class Layout>
+using layout_atomic =
+    atomic_base<payload<8>, std::mutex, std::lock_guard, Layout>;
+
+template <class Layout>
+using layout_optional = async::optional_base<payload<8>, std::optional,
+                                             std::nullopt_t, std::mutex,
+                                             std::lock_guard, Layout>;
+
+bench::suite latest_benches{"latest", [](const auto& opts) {
+                               latest_suite<8>(opts);
+                               latest_suite<64>(opts);
+                               latest_suite<1024>(opts);
+                             }};
+
+bench::suite copy_into_benches{"copy_into", copy_into_suite};
+
+bench::suite strand_benches{"strand", strand_suite};
+
+bench::suite false_sharing_benches{
+    "false_sharing", [](const auto& opts) {
+      using namespace async::layout;
+      per_thread_atomic_suite<layout_atomic<compact>>(opts,
+                                                      "per_thread/atomic");
+      per_thread_atomic_suite<layout_atomic<padded>>(
+          opts, "per_thread/atomic/padded");
+      per_thread_atomic_suite<layout_atomic<split>>(
+          opts, "per_thread/atomic/split");
+      per_thread_optional_suite<layout_optional<compact>>(
+          opts, "per_thread/optional");
+      per_thread_optional_suite<layout_optional<padded>>(
+          opts, "per_thread/optional/padded");
+    }};
+
+bench::suite atomic_benches{"atomic", [](const auto& opts) {
+                              atomic_suite<atomic, 8>(opts, "atomic");
+                              atomic_suite<atomic, 64>(opts, "atomic");
+                              atomic_suite<atomic, 1024>(opts, "atomic");
+                            }};
+
+bench::suite spin_atomic_benches{"spin_atomic", [](const auto& opts) {
+                                   atomic_suite<spin_atomic, 8>(
+                                       opts, "spin_atomic");
+                                   atomic_suite<spin_atomic, 64>(
+                                       opts, "spin_atomic");
+                                   atomic_suite<spin_atomic, 1024>(
+                                       opts, "spin_atomic");
+                                 }};
+
+bench::suite seqlock_atomic_benches{"seqlock_atomic", [](const auto& opts) {
+                                      seqlock_atomic_suite<8>(opts);
+                                      seqlock_atomic_suite<64>(opts);
+                                      seqlock_atomic_suite<1024>(opts);
+                                    }};
+
+bench::suite atomic_rw_benches{"atomic_rw", [](const auto& opts) {
+                                 atomic_rw_suite<atomic_rw, 8>(opts,
+                                                               "atomic_rw");
+                                 atomic_rw_suite<atomic_rw, 64>(opts,
+                                                                "atomic_rw");
+                                 atomic_rw_suite<atomic_rw, 1024>(
+                                     opts, "atomic_rw");
+                               }};
+
+/** run with e.g. `--threads 1,2,4,8,16,32,64` to see read scaling */
+bench::suite atomic_rw_scalable_benches{
+    "atomic_rw_scalable", [](const auto& opts) {
+      atomic_rw_suite<atomic_rw_scalable, 8>(opts, "atomic_rw_scalable");
+      atomic_rw_suite<atomic_rw_scalable, 64>(opts, "atomic_rw_scalable");
+      atomic_rw_suite<atomic_rw_scalable, 1024>(opts, "atomic_rw_scalable");
+    }};
+
+bench::suite atomic_rcu_benches{"atomic_rcu", [](const auto& opts) {
+                                  atomic_rcu_suite<8>(opts);
+                                  atomic_rcu_suite<64>(opts);
+                                  atomic_rcu_suite<1024>(opts);
+                                }};
+
+bench::suite optional_benches{"optional", [](const auto& opts) {
+                                optional_suite<8>(opts);
+                                optional_suite<1024>(opts);
+                              }};
+
+}  // namespace
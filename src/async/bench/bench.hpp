@@ -0,0 +1,163 @@
+#ifndef NIL_SRC_ASYNC_BENCH_BENCH_HPP_
+#define NIL_SRC_ASYNC_BENCH_BENCH_HPP_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace nil::bench {
+
+/**
+ * Small self-contained harness for the async_bench target.
+ *
+ * Every benchmark runs a fixed number of operations on each of N threads, all
+ * released together from a start barrier. Each operation is timed on its own,
+ * so the p50/p99 latencies include the ~20ns cost of reading the clock.
+ *
+ * @note allocations are counted by replacing global operator new inside the
+ * async_bench executable, see async_bench.cpp
+ */
+
+/** number of heap allocations the calling thread has made so far */
+std::size_t thread_allocations() noexcept;
+
+/** command line options, shared by every suite */
+struct options {
+  std::string filter{};                     //!< substring match on bench name
+  std::vector<std::size_t> threads{1, 2, 4};  //!< thread counts to sweep
+  std::size_t ops{100000};                  //!< operations per thread
+};
+
+/** a trivially copyable value of exactly N bytes, used to sweep value sizes */
+template <std::size_t N>
+struct payload {
+  std::array<char, N> bytes{};
+};
+
+/** keeps the compiler from discarding a value computed in a benchmark */
+template <class T>
+inline void do_not_optimize(T&& t) {
+  asm volatile("" : : "g"(&t) : "memory");
+}
+
+/** spreads ops over [0, 100) to pick reads vs writes for a given read ratio */
+inline bool is_read(std::size_t op_index, std::size_t read_percent) {
+  return (op_index * 37) % 100 < read_percent;
+}
+
+// suite registry --------------------------------------------------------------
+
+using suite_func = std::function<void(const options&)>;
+
+inline std::vector<std::pair<std::string, suite_func>>& suites() {
+  static std::vector<std::pair<std::string, suite_func>> s;
+  return s;
+}
+
+/** registers a suite at static init, use one per bench translation unit */
+struct suite {
+  suite(std::string name, suite_func f) {
+    suites().emplace_back(std::move(name), std::move(f));
+  }
+};
+
+// runner ----------------------------------------------------------------------
+
+inline void print_header() {
+  std::printf("%-48s %7s %14s %10s %10s %10s\n", "benchmark", "threads",
+              "ops/sec", "p50(ns)", "p99(ns)", "allocs/op");
+}
+
+/**
+ * Runs @p op on @p threads threads, @p opts.ops times each, and prints one
+ * result row. Skipped entirely if @p name doesn't match the filter.
+ *
+ * @param op - invocable as op(thread_index, op_index)
+ */
+template <class Op>
+void run(const options& opts, const std::string& name, std::size_t threads,
+         Op&& op) {
+  if (name.find(opts.filter) == std::string::npos) {
+    return;
+  }
+
+  using clock = std::chrono::steady_clock;
+
+  std::vector<std::vector<std::uint32_t>> latencies(
+      threads, std::vector<std::uint32_t>(opts.ops));
+  std::vector<std::size_t> allocs(threads, 0);
+  std::vector<clock::time_point> finish(threads);
+  std::atomic<std::size_t> ready{0};
+  std::atomic<bool> go{false};
+
+  auto worker = [&](std::size_t tid) {
+    auto& lat = latencies[tid];
+    ready.fetch_add(1);
+    while (!go.load(std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+
+    const auto allocs_before = thread_allocations();
+    for (std::size_t ii{0}; ii < opts.ops; ii++) {
+      const auto t0 = clock::now();
+      op(tid, ii);
+      const auto t1 = clock::now();
+      lat[ii] = static_cast<std::uint32_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0)
+              .count());
+    }
+    allocs[tid] = thread_allocations() - allocs_before;
+    finish[tid] = clock::now();
+  };
+
+  std::vector<std::thread> pool;
+  for (std::size_t tid{0}; tid < threads; tid++) {
+    pool.emplace_back(worker, tid);
+  }
+  while (ready.load() < threads) {
+    std::this_thread::yield();
+  }
+  const auto start = clock::now();
+  go.store(true, std::memory_order_release);
+  for (auto& t : pool) {
+    t.join();
+  }
+
+  const auto end = *std::max_element(finish.cbegin(), finish.cend());
+  const auto seconds = std::chrono::duration<double>(end - start).count();
+  const auto total_ops = threads * opts.ops;
+
+  std::vector<std::uint32_t> all;
+  all.reserve(total_ops);
+  for (const auto& lat : latencies) {
+    all.insert(all.end(), lat.cbegin(), lat.cend());
+  }
+  auto percentile = [&all](double p) {
+    auto nth = all.begin() + static_cast<std::ptrdiff_t>(p * (all.size() - 1));
+    std::nth_element(all.begin(), nth, all.end());
+    return *nth;
+  };
+  const auto p50 = percentile(0.50);
+  const auto p99 = percentile(0.99);
+
+  std::size_t total_allocs{0};
+  for (auto a : allocs) {
+    total_allocs += a;
+  }
+
+  std::printf("%-48s %7zu %14.0f %10u %10u %10.3f\n", name.c_str(), threads,
+              total_ops / seconds, p50, p99,
+              static_cast<double>(total_allocs) / total_ops);
+}
+
+}  // namespace nil::bench
+
+#endif  // NIL_SRC_ASYNC_BENCH_BENCH_HPP_
@@ -0,0 +1,178 @@
+#include <unordered_map>
+
+#include "async/atomic.hpp"
+#include "async/combining_deque.hpp"
+#include "async/combining_vector.hpp"
+#include "async/deque.hpp"
+#include "async/list.hpp"
+#include "async/unordered_map.hpp"
+#include "async/vector.hpp"
+#include "bench.hpp"
+
+using namespace nil;
+using nil::bench::payload;
+
+namespace {
+
+template <class C>
+void push_back_suite(const bench::options& opts, const std::string& prefix) {
+  using value_t = typename C::value_type;
+
+  for (auto threads : opts.threads) {
+    C c;
+    bench::run(opts, prefix + "/push_back", threads,
+               [&](auto, auto) { c.push_back(value_t{}); });
+  }
+}
+
+template <class C>
+void queue_suite(const bench::options& opts, const std::string& prefix) {
+  using value_t = typename C::value_type;
+
+  push_back_suite<C>(opts, prefix);
+
+  for (auto threads : opts.threads) {
+    C c;
+    bench::run(opts, prefix + "/push_back_extract_front", threads,
+               [&](auto, auto ii) {
+                 if (ii % 2 == 0) {
+                   c.push_back(value_t{});
+                 } else {
+                   bench::do_not_optimize(c.extract_front());
+                 }
+               });
+  }
+}
+
+template <class C>
+void batch_suite(const bench::options& opts, const std::string& prefix) {
+  using container_type = typename C::container_type;
+  using value_t = typename C::value_type;
+  constexpr std::size_t batch = 32;
+
+  for (auto threads : opts.threads) {
+    C c;
+    const std::vector<value_t> in(batch);
+    bench::run(opts, prefix + "/push_back_range_x32", threads,
+               [&](auto, auto) { c.push_back_range(in.cbegin(), in.cend()); });
+  }
+
+  for (auto threads : opts.threads) {
+    C c;
+    std::vector<value_t> out;
+    out.reserve(batch);
+    bench::run(opts, prefix + "/push_back_range_extract_front_n_x32", threads,
+               [&](auto, auto ii) {
+                 if (ii % 2 == 0) {
+                   c.push_back_bulk(container_type(batch));
+                 } else {
+                   out.clear();
+                   c.extract_front_n(batch, std::back_inserter(out));
+                 }
+               });
+  }
+}
+
+template <class C>
+void apply_each_suite(const bench::options& opts, const std::string& prefix) {
+  using value_t = typename C::value_type;
+
+  for (auto read_pct : {90, 99}) {
+    const auto name = prefix + "/apply_each_push_back/r" +
+                      std::to_string(read_pct);
+    for (auto threads : opts.threads) {
+      C c;
+      for (int ii{0}; ii < 64; ii++) {
+        c.push_back(value_t{});
+      }
+      bench::run(opts, name, threads, [&](auto, auto ii) {
+        if (bench::is_read(ii, read_pct)) {
+          std::size_t sum{0};
+          std::as_const(c).apply_each(
+              [&sum](const auto& v) { sum += v.bytes[0]; });
+          bench::do_not_optimize(sum);
+        } else {
+          c.apply([](typename C::container_type& ct) {
+            ct.back().bytes[0]++;
+          });
+        }
+      });
+    }
+  }
+}
+
+/** one mutex around the whole map, what unordered_map replaces */
+template <class V>
+struct single_lock_map {
+  nil::atomic<std::unordered_map<int, V>> map;
+
+  std::optional<V> find(int key) const {
+    return map.apply([key](const auto& m) -> std::optional<V> {
+      const auto it = m.find(key);
+      return it == m.end() ? std::nullopt : std::optional<V>{it->second};
+    });
+  }
+
+  void insert_or_assign(int key, const V& v) {
+    map.apply([&](auto& m) { m.insert_or_assign(key, v); });
+  }
+};
+
+template <class M>
+void map_suite(const bench::options& opts, const std::string& prefix) {
+  using value_t = payload<8>;
+  constexpr int keys = 1024;
+
+  for (auto read_pct : {50, 90}) {
+    const auto name = prefix + "/find_insert_or_assign/r" +
+                      std::to_string(read_pct);
+    for (auto threads : opts.threads) {
+      M m;
+      for (int ii{0}; ii < keys; ii++) {
+        m.insert_or_assign(ii, value_t{});
+      }
+      bench::run(opts, name, threads, [&](auto tid, auto ii) {
+        const auto key = static_cast<int>((ii * 7919 + tid * 31) % keys);
+        if (bench::is_read(ii, read_pct)) {
+          bench::do_not_optimize(m.find(key));
+        } else {
+          m.insert_or_assign(key, value_t{});
+        }
+      });
+    }
+  }
+}
+
+bench::suite container_benches{"container", [](const auto& opts) {
+                                 queue_suite<async::deque<payload<8>>>(
+                                     opts, "deque/8B");
+                                 queue_suite<async::deque<payload<256>>>(
+                                     opts, "deque/256B");
+                                 queue_suite<async::list<payload<8>>>(
+                                     opts, "list/8B");
+                                 batch_suite<async::deque<payload<8>>>(
+                                     opts, "deque/8B");
+                                 batch_suite<async::list<payload<8>>>(
+                                     opts, "list/8B");
+                                 apply_each_suite<async::vector<payload<8>>>(
+                                     opts, "vector/8B");
+                               }};
+
+bench::suite combining_benches{
+    "combining", [](const auto& opts) {
+      push_back_suite<async::vector<payload<8>>>(opts, "vector/8B");
+      push_back_suite<async::combining_vector<payload<8>>>(
+          opts, "combining_vector/8B");
+      queue_suite<async::deque<payload<8>>>(opts, "deque/8B");
+      queue_suite<async::combining_deque<payload<8>>>(opts,
+                                                      "combining_deque/8B");
+    }};
+
+bench::suite map_benches{"map", [](const auto& opts) {
+                           map_suite<single_lock_map<payload<8>>>(
+                               opts, "atomic<unordered_map>");
+                           map_suite<async::unordered_map<int, payload<8>>>(
+                               opts, "unordered_map");
+                         }};
+
+}  // namespace
@@ -0,0 +1,108 @@
+#include <functional>
+#include <thread>
+
+#include "async/cache_line.hpp"
+#include "async/deque.hpp"
+#include "async/thread_pool.hpp"
+#include "bench.hpp"
+
+using namespace nil;
+
+namespace {
+
+/**
+ * The ad-hoc pool thread_pool replaces: every worker waits on one shared
+ * nil::async::deque, and every post and every pop contends on its mutex
+ */
+class deque_pool {
+ public:
+  explicit deque_pool(std::size_t threads) {
+    for (std::size_t ii{0}; ii < threads; ii++) {
+      workers_.emplace_back([this]() {
+        while (auto f = queue_.wait_extract_front()) {
+          f();
+        }
+      });
+    }
+  }
+
+  /** an empty function tells a worker to stop */
+  ~deque_pool() {
+    for (std::size_t ii{0}; ii < workers_.size(); ii++) {
+      queue_.push_back(std::function<void()>{});
+    }
+    for (auto& w : workers_) {
+      w.join();
+    }
+  }
+
+  template <class F>
+  void post(F&& f) {
+    queue_.push_back(std::function<void()>{std::forward<F>(f)});
+  }
+
+ private:
+  async::deque<std::function<void()>> queue_;
+  std::vector<std::thread> workers_;
+};
+
+/** jobs a posting thread is still waiting for, one cache line per poster */
+struct alignas(async::cache_line_size) pending {
+  std::atomic<int> left{0};
+};
+
+constexpr std::size_t workers = 4;
+constexpr int fan_out = 16;
+
+void wait_for(const pending& p) {
+  while (p.left.load(std::memory_order_acquire) != 0) {
+    std::this_thread::yield();
+  }
+}
+
+/**
+ * Each op posts 16 tiny jobs and waits for them, either straight from the
+ * benchmark thread, or from inside one job that fans out. The nested variant
+ * is where per-worker deques pay off: the children never touch a shared lock
+ */
+template <class Pool>
+void pool_suite(const bench::options& opts, const std::string& pool_name) {
+  const auto prefix = "pool/" + pool_name;
+
+  for (auto threads : opts.threads) {
+    Pool pool{workers};
+    std::vector<pending> left(threads);
+    bench::run(opts, prefix + "/external_x16", threads, [&](auto tid, auto) {
+      auto& p = left[tid];
+      p.left.store(fan_out, std::memory_order_relaxed);
+      for (int ii{0}; ii < fan_out; ii++) {
+        pool.post([&p]() { p.left.fetch_sub(1, std::memory_order_release); });
+      }
+      wait_for(p);
+    });
+  }
+
+  for (auto threads : opts.threads) {
+    Pool pool{workers};
+    std::vector<pending> left(threads);
+    bench::run(opts, prefix + "/nested_x16", threads, [&](auto tid, auto) {
+      auto& p = left[tid];
+      p.left.store(fan_out, std::memory_order_relaxed);
+      pool.post([&pool, &p]() {
+        for (int ii{0}; ii < fan_out; ii++) {
+          pool.post(
+              [&p]() { p.left.fetch_sub(1, std::memory_order_release); });
+        }
+      });
+      wait_for(p);
+    });
+  }
+}
+
+bench::suite pool_benches{"pool", [](const auto& opts) {
+                            pool_suite<deque_pool>(opts, "deque");
+                            pool_suite<async::thread_pool>(opts,
+                                                           "thread_pool");
+                          }};
+
+}  // namespace
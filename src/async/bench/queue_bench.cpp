@@ -0,0 +1,112 @@
+#include "async/deque.hpp"
+#include "async/mpmc_queue.hpp"
+#include "async/spsc_queue.hpp"
+#include "bench.hpp"
+
+using namespace nil;
+using nil::bench::payload;
+
+namespace {
+
+/**
+ * Work queue hand-off, each thread alternates between producing and consuming
+ * so the queue never fills or drains for long.
+ */
+template <std::size_t N>
+void work_queue_suite(const bench::options& opts) {
+  using value_t = payload<N>;
+  const auto suffix = "/" + std::to_string(N) + "B";
+
+  for (auto threads : opts.threads) {
+    async::deque<value_t> q;
+    bench::run(opts, "work_queue/deque" + suffix, threads, [&](auto, auto ii) {
+      if (ii % 2 == 0) {
+        q.push_back(value_t{});
+      } else {
+        bench::do_not_optimize(q.extract_front());
+      }
+    });
+  }
+
+  for (auto threads : opts.threads) {
+    async::mpmc_queue<value_t> q{1024};
+    bench::run(opts, "work_queue/mpmc_queue" + suffix, threads,
+               [&](auto, auto ii) {
+                 if (ii % 2 == 0) {
+                   q.try_push(value_t{});
+                 } else {
+                   bench::do_not_optimize(q.try_pop());
+                 }
+               });
+  }
+}
+
+/**
+ * One producer thread and one consumer thread, each op is one element handed
+ * from thread 0 to thread 1, or one batch of 32 for the bulk variant
+ */
+template <std::size_t N>
+void pipeline_suite(const bench::options& opts) {
+  using value_t = payload<N>;
+  const auto suffix = "/" + std::to_string(N) + "B";
+  constexpr std::size_t threads = 2;
+  constexpr std::size_t batch = 32;
+
+  {
+    async::deque<value_t> q;
+    bench::run(opts, "pipeline/deque" + suffix, threads, [&](auto tid, auto) {
+      if (tid == 0) {
+        q.push_back(value_t{});
+      } else {
+        while (!q.extract_front()) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  {
+    async::spsc_queue<value_t> q{1024};
+    bench::run(opts, "pipeline/spsc_queue" + suffix, threads,
+               [&](auto tid, auto) {
+                 if (tid == 0) {
+                   while (!q.try_push(value_t{})) {
+                     std::this_thread::yield();
+                   }
+                 } else {
+                   while (!q.try_pop()) {
+                     std::this_thread::yield();
+                   }
+                 }
+               });
+  }
+
+  {
+    async::spsc_queue<value_t> q{1024};
+    std::array<value_t, batch> in{};
+    std::array<value_t, batch> out{};
+    bench::run(opts, "pipeline/spsc_queue_x32" + suffix, threads,
+               [&](auto tid, auto) {
+                 std::size_t done{0};
+                 while (done < batch) {
+                   done += tid == 0 ? q.push_n(in.cbegin(), batch - done)
+                                    : q.pop_n(out.begin(), batch - done);
+                   if (done < batch) {
+                     std::this_thread::yield();
+                   }
+                 }
+               });
+  }
+}
+
+bench::suite pipeline_benches{"pipeline", [](const auto& opts) {
+                                pipeline_suite<8>(opts);
+                                pipeline_suite<256>(opts);
+                              }};
+
+bench::suite work_queue_benches{"work_queue", [](const auto& opts) {
+                                  work_queue_suite<8>(opts);
+                                  work_queue_suite<256>(opts);
+                                }};
+
+}  // namespace
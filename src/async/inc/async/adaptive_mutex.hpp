@@ -0,0 +1,135 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_ADAPTIVEMUTEX_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_ADAPTIVEMUTEX_HPP_
+
+#include <atomic>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace nil::async {
+
+/** hints to the CPU that we're in a spin-wait loop */
+inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+  _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+/**
+ * A mutex that spins for a short while before parking the thread, for short
+ * critical sections (like atomic_base::push) where std::mutex would often go
+ * to sleep on a syscall just before the lock was released.
+ *
+ * Spinning uses the CPU's pause instruction with exponential backoff, and only
+ * reads the lock word while it's held, so spinners don't bounce the cache line
+ * between them. Once the spin budget is used up the thread parks on a futex
+ * (Linux), or a condition variable elsewhere. Unlocking only makes a syscall
+ * if a thread is actually parked.
+ *
+ * Meets the Lockable requirements, so it can be used as the Mutex parameter of
+ * atomic_base, container_base, optional_base, etc.
+ *
+ * @note not fair. On an oversubscribed machine spinning is wasted work, since
+ * the owner may not be running, so keep `spin_limit` small
+ */
+class adaptive_mutex {
+ public:
+  /** number of lock attempts before parking */
+  static constexpr int spin_limit = 16;
+  /** most pause instructions between two attempts */
+  static constexpr int max_backoff = 64;
+
+  adaptive_mutex() = default;
+  adaptive_mutex(const adaptive_mutex&) = delete;
+  adaptive_mutex& operator=(const adaptive_mutex&) = delete;
+
+  void lock() noexcept {
+    int backoff = 1;
+    for (int ii{0}; ii < spin_limit; ii++) {
+      if (state_.load(std::memory_order_relaxed) == unlocked && try_lock()) {
+        return;
+      }
+      for (int jj{0}; jj < backoff; jj++) {
+        cpu_relax();
+      }
+      backoff = backoff < max_backoff ? backoff * 2 : max_backoff;
+    }
+
+    // from here on, anyone holding the lock must wake us when unlocking
+    while (state_.exchange(contended, std::memory_order_acquire) != unlocked) {
+      park();
+    }
+  }
+
+  bool try_lock() noexcept {
+    auto expected = unlocked;
+    return state_.compare_exchange_strong(expected, locked,
+                                          std::memory_order_acquire,
+                                          std::memory_order_relaxed);
+  }
+
+  void unlock() noexcept {
+    if (state_.exchange(unlocked, std::memory_order_release) == contended) {
+      wake_one();
+    }
+  }
+
+ private:
+  static constexpr std::int32_t unlocked = 0;
+  static constexpr std::int32_t locked = 1;    //!< no thread is parked
+  static constexpr std::int32_t contended = 2;  //!< threads may be parked
+
+#if defined(__linux__)
+  static_assert(sizeof(std::atomic<std::int32_t>) == sizeof(std::int32_t) &&
+                    std::atomic<std::int32_t>::is_always_lock_free,
+                "futex requires a plain 32 bit lock word");
+
+  int* futex_word() noexcept { return reinterpret_cast<int*>(&state_); }
+
+  /** sleeps only if the lock is still contended */
+  void park() noexcept {
+    syscall(SYS_futex, futex_word(), FUTEX_WAIT_PRIVATE, contended, nullptr,
+            nullptr, 0);
+  }
+
+  void wake_one() noexcept {
+    syscall(SYS_futex, futex_word(), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr,
+            0);
+  }
+#else
+  /** sleeps only if the lock is still contended */
+  void park() noexcept {
+    std::unique_lock<std::mutex> lock{park_mutex_};
+    while (state_.load(std::memory_order_relaxed) == contended) {
+      park_cv_.wait(lock);
+    }
+  }
+
+  void wake_one() noexcept {
+    { std::lock_guard<std::mutex> lock{park_mutex_}; }
+    park_cv_.notify_one();
+  }
+
+  std::mutex park_mutex_;
+  std::condition_variable park_cv_;
+#endif
+
+  std::atomic<std::int32_t> state_{unlocked};
+};
+
+}  // namespace nil::async
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_ADAPTIVEMUTEX_HPP_
@@ -0,0 +1,246 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_APPLYALL_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_APPLYALL_HPP_
+
+#include <functional>
+#include <mutex>
+#include <tuple>
+
+#include "async/atomic_base.hpp"
+#include "async/atomic_rw_base.hpp"
+#include "async/container_base.hpp"
+#include "async/lock_access.hpp"
+#include "async/optional_base.hpp"
+
+namespace nil {
+
+namespace async::detail {
+
+// how apply_all locks each wrapper --------------------------------------------
+
+/**
+ * Every participant is Lockable, so they all go into one std::scoped_lock.
+ * locked() is called once all of them are held, and the destructor runs after
+ * they have all been released
+ */
+template <class W>
+class exclusive_lockable {
+ public:
+  explicit exclusive_lockable(W& w) noexcept : w_{w} {}
+  exclusive_lockable(const exclusive_lockable&) = delete;
+  exclusive_lockable& operator=(const exclusive_lockable&) = delete;
+
+  void lock() { lock_access::mutex(w_).lock(); }
+  bool try_lock() { return lock_access::mutex(w_).try_lock(); }
+  void unlock() { lock_access::mutex(w_).unlock(); }
+
+ protected:
+  W& w_;
+};
+
+/** const atomic_base or optional_base */
+template <class W>
+class value_reader : public exclusive_lockable<const W> {
+ public:
+  using exclusive_lockable<const W>::exclusive_lockable;
+
+  void locked() noexcept {}
+  const auto& data() const noexcept { return lock_access::value(this->w_); }
+};
+
+/** atomic_base or optional_base, bumps the version and wakes waiters */
+template <class W>
+class value_writer : public exclusive_lockable<W> {
+ public:
+  explicit value_writer(W& w) noexcept
+      : exclusive_lockable<W>{w}, notify_{lock_access::signal(w)} {}
+
+  void locked() noexcept { notify_.changed(); }
+  auto& data() const noexcept { return lock_access::value(this->w_); }
+
+ private:
+  change_signal::notifier notify_;
+};
+
+/** const container_base */
+template <class W>
+class elements_reader : public exclusive_lockable<const W> {
+ public:
+  using exclusive_lockable<const W>::exclusive_lockable;
+
+  void locked() noexcept {}
+  const auto& data() const noexcept { return lock_access::elements(this->w_); }
+};
+
+/**
+ * container_base, wakes all waiters in case elements were added, the same way
+ * a non-const apply does
+ */
+template <class W>
+class elements_writer : public exclusive_lockable<W> {
+ public:
+  explicit elements_writer(W& w) : exclusive_lockable<W>{w}, notify_{w, true} {}
+
+  void locked() { notify_.arm(); }
+  auto& data() const noexcept { return lock_access::elements(this->w_); }
+
+ private:
+  lock_access::notifier<W> notify_;
+};
+
+/** const atomic_rw_base, only takes the shared lock */
+template <class W>
+class shared_reader {
+ public:
+  explicit shared_reader(const W& w) noexcept : w_{w} {}
+  shared_reader(const shared_reader&) = delete;
+  shared_reader& operator=(const shared_reader&) = delete;
+
+  void lock() { lock_access::mutex(w_).lock_shared(); }
+  bool try_lock() { return lock_access::mutex(w_).try_lock_shared(); }
+  void unlock() { lock_access::mutex(w_).unlock_shared(); }
+
+  void locked() noexcept {}
+  const auto& data() const noexcept { return lock_access::value(w_); }
+
+ private:
+  const W& w_;
+};
+
+/**
+ * atomic_rw_base, passes the upgrade gate (if it has one) before taking the
+ * exclusive lock, like atomic_rw_base::write, and bumps the version
+ */
+template <class W>
+class gated_writer {
+ public:
+  explicit gated_writer(W& w) noexcept : w_{w} {}
+  gated_writer(const gated_writer&) = delete;
+  gated_writer& operator=(const gated_writer&) = delete;
+
+  void lock() {
+    if constexpr (W::is_upgradeable) {
+      lock_access::upgrade_gate(w_).lock();
+    }
+    lock_access::mutex(w_).lock();
+  }
+
+  bool try_lock() {
+    if constexpr (W::is_upgradeable) {
+      if (!lock_access::upgrade_gate(w_).try_lock()) {
+        return false;
+      }
+    }
+    if (!lock_access::mutex(w_).try_lock()) {
+      if constexpr (W::is_upgradeable) {
+        lock_access::upgrade_gate(w_).unlock();
+      }
+      return false;
+    }
+    return true;
+  }
+
+  void unlock() {
+    lock_access::mutex(w_).unlock();
+    if constexpr (W::is_upgradeable) {
+      lock_access::upgrade_gate(w_).unlock();
+    }
+  }
+
+  void locked() noexcept { lock_access::changed(w_); }
+  auto& data() const noexcept { return lock_access::value(w_); }
+
+ private:
+  W& w_;
+};
+
+// participant for each wrapper ------------------------------------------------
+
+template <class W>
+struct participant;
+
+template <class T, class M, template <class> class L, class Layout>
+struct participant<atomic_base<T, M, L, Layout>> {
+  using type = value_writer<atomic_base<T, M, L, Layout>>;
+};
+
+template <class T, class M, template <class> class L, class Layout>
+struct participant<const atomic_base<T, M, L, Layout>> {
+  using type = value_reader<atomic_base<T, M, L, Layout>>;
+};
+
+template <class T, template <class> class O, class N, class M,
+          template <class> class L, class Layout>
+struct participant<optional_base<T, O, N, M, L, Layout>> {
+  using type = value_writer<optional_base<T, O, N, M, L, Layout>>;
+};
+
+template <class T, template <class> class O, class N, class M,
+          template <class> class L, class Layout>
+struct participant<const optional_base<T, O, N, M, L, Layout>> {
+  using type = value_reader<optional_base<T, O, N, M, L, Layout>>;
+};
+
+template <class C, class M, template <class> class L, class Layout>
+struct participant<container_base<C, M, L, Layout>> {
+  using type = elements_writer<container_base<C, M, L, Layout>>;
+};
+
+template <class C, class M, template <class> class L, class Layout>
+struct participant<const container_base<C, M, L, Layout>> {
+  using type = elements_reader<container_base<C, M, L, Layout>>;
+};
+
+template <class T, class M, template <class> class WL,
+          template <class> class RL, class Layout, class G>
+struct participant<atomic_rw_base<T, M, WL, RL, Layout, G>> {
+  using type = gated_writer<atomic_rw_base<T, M, WL, RL, Layout, G>>;
+};
+
+template <class T, class M, template <class> class WL,
+          template <class> class RL, class Layout, class G>
+struct participant<const atomic_rw_base<T, M, WL, RL, Layout, G>> {
+  using type = shared_reader<atomic_rw_base<T, M, WL, RL, Layout, G>>;
+};
+
+template <class W>
+using participant_t = typename participant<W>::type;
+
+}  // namespace async::detail
+
+/**
+ * Locks all of @p ws at once and invokes @p f with references to all of their
+ * data, in a single critical section:
+ *
+ * @code
+ *   nil::apply_all([](auto& from, auto& to, const auto& log) { ... },
+ *                  account_a, account_b, std::as_const(audit_log));
+ * @endcode
+ *
+ * Works with any mix of atomic_base, atomic_rw_base, optional_base and
+ * container_base. The locks are taken with std::scoped_lock, which backs off
+ * and retries rather than deadlocking, whatever order other threads lock the
+ * same objects in.
+ *
+ * Wrappers passed as const are read-only to @p f. A const atomic_rw_base only
+ * takes the shared lock, everything else is locked exclusively. Non-const
+ * wrappers count as changed: versions are bumped and waiters woken, the same
+ * as a non-const apply.
+ *
+ * @note passing the same object twice deadlocks
+ */
+template <class F, class... Ws>
+auto apply_all(F&& f, Ws&... ws) {
+  static_assert(sizeof...(Ws) > 0, "apply_all needs something to lock");
+  std::tuple<async::detail::participant_t<Ws>...> parts{ws...};
+  return std::apply(
+      [&f](auto&... p) {
+        std::scoped_lock lock{p...};
+        (p.locked(), ...);
+        return std::invoke(std::forward<F>(f), p.data()...);
+      },
+      parts);
+}
+
+}  // namespace nil
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_APPLYALL_HPP_
@@ -0,0 +1,305 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_ASYNCMUTEX_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_ASYNCMUTEX_HPP_
+
+#ifdef NIL_ASYNC_COROUTINES
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "async/adaptive_mutex.hpp"
+#include "async/task.hpp"
+
+namespace nil::async {
+
+namespace detail {
+
+/**
+ * Resumes coroutines that were handed a lock one after the other, rather than
+ * nested inside each other, so a long chain of hand-overs doesn't grow the
+ * stack. One resumed from inside another runs once that one suspends or ends
+ */
+class resume_queue {
+ public:
+  static void resume(std::coroutine_handle<> h) {
+    auto& q = local();
+    q.handles_.push_back(h);
+    if (q.running_) {
+      return;
+    }
+    q.running_ = true;
+    q.run_pending();
+    q.handles_.clear();
+    q.next_ = 0;
+    q.running_ = false;
+  }
+
+  /** runs what this thread deferred, before it blocks waiting for a lock */
+  static void flush() {
+    auto& q = local();
+    if (q.running_) {
+      q.run_pending();
+    }
+  }
+
+ private:
+  static resume_queue& local() {
+    thread_local resume_queue q;
+    return q;
+  }
+
+  void run_pending() {
+    while (next_ < handles_.size()) {
+      auto h = handles_[next_++];
+      h.resume();
+    }
+  }
+
+  std::vector<std::coroutine_handle<>> handles_;
+  std::size_t next_{0};
+  bool running_{false};
+};
+
+}  // namespace detail
+
+/**
+ * A mutex coroutines can co_await, so waiting for it suspends the coroutine
+ * rather than blocking the thread:
+ *
+ * @code
+ *   co_await mutex.lock_async();
+ *   std::lock_guard<async_mutex> lock{mutex, std::adopt_lock};
+ * @endcode
+ *
+ * Also meets the Lockable requirements, so plain threads can lock it too, and
+ * it works as the Mutex parameter of atomic_base, optional_base and
+ * container_base, which then provide apply_async and friends.
+ *
+ * Waiters are served in FIFO order. unlock() hands the lock straight to the
+ * next waiter. A waiting thread is woken up, and a waiting coroutine is resumed
+ * on the unlocking thread, inside that call to unlock(). If that thread is
+ * itself running a coroutine resumed this way, the next one is queued and runs
+ * as soon as the current one suspends, so the stack stays flat.
+ *
+ * @note only available when building with NIL_ASYNC_COROUTINES (C++20)
+ */
+class async_mutex {
+  /** a thread blocked in lock() */
+  struct blocked_thread {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool ready{false};
+  };
+
+  /** a coroutine or thread waiting for the lock */
+  struct waiter {
+    waiter* next{nullptr};
+    std::coroutine_handle<> coroutine;  //!< resumed, if set
+    blocked_thread* thread{nullptr};    //!< woken otherwise
+  };
+
+ public:
+  async_mutex() = default;
+  async_mutex(const async_mutex&) = delete;
+  async_mutex& operator=(const async_mutex&) = delete;
+
+  /** co_await it to take the lock, which is held once the coroutine resumes */
+  class lock_awaiter {
+   public:
+    explicit lock_awaiter(async_mutex& m) noexcept : m_{m} {}
+
+    bool await_ready() noexcept { return m_.try_lock(); }
+
+    /** doesn't suspend after all if the lock was released meanwhile */
+    bool await_suspend(std::coroutine_handle<> h) noexcept {
+      w_.coroutine = h;
+      return m_.enqueue(w_);
+    }
+
+    void await_resume() noexcept {}
+
+   private:
+    async_mutex& m_;
+    waiter w_;
+  };
+
+  lock_awaiter lock_async() noexcept { return lock_awaiter{*this}; }
+
+  // Lockable ------------------------------------------------------------------
+
+  void lock() {
+    blocked_thread thread;
+    waiter w;
+    w.thread = &thread;
+    if (!enqueue(w)) {
+      return;
+    }
+    // the lock may be handed to a coroutine this thread has yet to resume
+    detail::resume_queue::flush();
+    std::unique_lock<std::mutex> lock{thread.mutex};
+    thread.cv.wait(lock, [&thread]() { return thread.ready; });
+  }
+
+  bool try_lock() noexcept {
+    std::lock_guard<adaptive_mutex> lock{state_mutex_};
+    if (locked_) {
+      return false;
+    }
+    locked_ = true;
+    return true;
+  }
+
+  /** hands the lock to the next waiter, if there is one */
+  void unlock() {
+    waiter* next;
+    {
+      std::lock_guard<adaptive_mutex> lock{state_mutex_};
+      next = head_;
+      if (!next) {
+        locked_ = false;
+        return;
+      }
+      head_ = next->next;
+      if (!head_) {
+        tail_ = nullptr;
+      }
+    }
+
+    // still locked, now on behalf of next
+    if (next->coroutine) {
+      detail::resume_queue::resume(next->coroutine);
+      return;
+    }
+    auto& thread = *next->thread;
+    std::lock_guard<std::mutex> lock{thread.mutex};
+    thread.ready = true;
+    thread.cv.notify_one();
+  }
+
+ private:
+  /** queues @p w, or returns false if the lock was free and is now ours */
+  bool enqueue(waiter& w) noexcept {
+    std::lock_guard<adaptive_mutex> lock{state_mutex_};
+    if (!locked_) {
+      locked_ = true;
+      return false;
+    }
+    if (tail_) {
+      tail_->next = &w;
+    } else {
+      head_ = &w;
+    }
+    tail_ = &w;
+    return true;
+  }
+
+  adaptive_mutex state_mutex_;  //!< guards everything below, held briefly
+  bool locked_{false};
+  waiter* head_{nullptr};
+  waiter* tail_{nullptr};
+};
+
+/**
+ * Coroutines waiting for data guarded by an async_mutex to change, the
+ * coroutine counterpart of a condition variable. Used by the
+ * wait_extract_*_async functions of container_base.
+ *
+ * @note only available when building with NIL_ASYNC_COROUTINES (C++20)
+ */
+class async_waiters {
+  struct node {
+    node* next{nullptr};
+    std::coroutine_handle<> coroutine;
+  };
+
+ public:
+  /** waiters detached by take, to be resumed once the lock is released */
+  class batch {
+   public:
+    batch() = default;
+    batch(const batch&) = delete;
+    batch& operator=(const batch&) = delete;
+
+    /** must only be assigned to while empty */
+    batch& operator=(batch&& other) noexcept {
+      head_ = std::exchange(other.head_, nullptr);
+      return *this;
+    }
+
+    /** resumes everyone, in the order they started waiting */
+    ~batch() {
+      while (head_) {
+        auto* n = std::exchange(head_, head_->next);
+        detail::resume_queue::resume(n->coroutine);
+      }
+    }
+
+   private:
+    friend class async_waiters;
+    explicit batch(node* head) noexcept : head_{head} {}
+
+    node* head_{nullptr};
+  };
+
+  /** co_await with @p mutex held: releases it, and sleeps until notified */
+  class wait_awaiter {
+   public:
+    wait_awaiter(async_waiters& w, async_mutex& m) noexcept : w_{w}, m_{m} {}
+
+    bool await_ready() noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> h) {
+      n_.coroutine = h;
+      w_.push(n_);
+      m_.unlock();  // may resume us straight away, don't touch *this after
+    }
+
+    void await_resume() noexcept {}
+
+   private:
+    async_waiters& w_;
+    async_mutex& m_;
+    node n_;
+  };
+
+  /**
+   * Must be co_awaited with @p mutex held. The coroutine resumes without it,
+   * after it's taken, and must lock it again to check the data
+   */
+  wait_awaiter wait(async_mutex& mutex) noexcept {
+    return wait_awaiter{*this, mutex};
+  }
+
+  /** detaches every waiter, or just the first, must hold the lock */
+  batch take(bool all) noexcept {
+    if (all || !head_ || !head_->next) {
+      tail_ = nullptr;
+      return batch{std::exchange(head_, nullptr)};
+    }
+    auto* first = std::exchange(head_, head_->next);
+    first->next = nullptr;
+    return batch{first};
+  }
+
+ private:
+  void push(node& n) noexcept {
+    if (tail_) {
+      tail_->next = &n;
+    } else {
+      head_ = &n;
+    }
+    tail_ = &n;
+  }
+
+  node* head_{nullptr};  //!< guarded by the async_mutex
+  node* tail_{nullptr};
+};
+
+}  // namespace nil::async
+
+#endif  // NIL_ASYNC_COROUTINES
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_ASYNCMUTEX_HPP_
@@ -15,6 +15,14 @@ namespace nil {
 template <class T>
 using atomic = atomic_base<T, std::mutex, std::lock_guard>;
 
+/**
+ * Same as atomic, but on its own cache line(s). Prefer this for arrays of
+ * per-thread instances, so neighbours don't falsely share a cache line
+ */
+template <class T>
+using padded_atomic =
+    atomic_base<T, std::mutex, std::lock_guard, async::layout::padded>;
+
 }  // namespace nil
 
 #endif  // NIL_SRC_ASYNC_INC_ASYNC_ATOMIC_HPP_
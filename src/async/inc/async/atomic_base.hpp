@@ -1,8 +1,25 @@
 #ifndef NIL_SRC_ASYNC_INC_ASYNC_ATOMICBASE_HPP_
 #define NIL_SRC_ASYNC_INC_ASYNC_ATOMICBASE_HPP_
 
+#include <chrono>
 #include <functional>
 #include <meta/enable_if.hpp>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "async/change_signal.hpp"
+#include "async/layout.hpp"
+#include "async/lock_access.hpp"
+#include "async/try_result.hpp"
+
+#ifdef NIL_ASYNC_COROUTINES
+#include <type_traits>
+
+#include "async/async_mutex.hpp"
+#include "async/task.hpp"
+#endif
 
 namespace nil {
 
@@ -15,18 +32,37 @@ namespace nil {
  * In addition to the standard push and peek, apply takes any function, allowing
  * you to perform complex operations while the mutex is locked
  *
- * @tparam T - any copyable type
+ * wait_until and wait_for block until a predicate holds for the data, waking
+ * only when push or apply (non-const) has run. Mutations only make a syscall
+ * if someone is waiting
+ *
+ * Every mutation also bumps a version, which can be read without the lock.
+ * peek_if_newer only copies the data if the version moved on, so polling large
+ * data that rarely changes is cheap
+ *
+ * try_push and try_apply give up instead of waiting if the mutex is taken, so
+ * latency-critical threads can skip or defer the work. try_apply_for waits up
+ * to a timeout, which needs a timed mutex like std::timed_mutex
+ *
+ * With NIL_ASYNC_COROUTINES and an async::async_mutex, coroutines can
+ * co_await apply_async, which suspends them rather than the thread while the
+ * mutex is taken
+ *
+ * @tparam T - any movable type. peek and peek_if_newer need it to be copyable
  * @tparam Mutex - a standard mutex, like std::mutex
  * @tparam LockGuard - an RAII lock, like std::lock_guard
+ * @tparam Layout - one of the nil::async::layout policies, defaults to compact
  */
-template <class T, class Mutex, template <class> class LockGuard>
+template <class T, class Mutex, template <class> class LockGuard,
+          class Layout = async::layout::compact>
 class atomic_base {
-  static_assert(std::is_copy_constructible_v<T>, "T must be copyable");
-
  public:
   using value_type = T;
   using mutex_type = Mutex;
   using lock_type_t = LockGuard<Mutex>;
+  using try_lock_type_t = std::unique_lock<Mutex>;
+  using layout_type = Layout;
+  using version_type = async::change_signal::version_type;
 
   // constructors --------------------------------------------------------------
 
@@ -45,19 +81,122 @@ class atomic_base {
 
   // get a copy of data --------------------------------------------------------
 
+  template <class U = T, if_copy_constructible<U>* = nullptr>
   T peek() const {
     lock_type_t lock(mutex_);
     return t_;
   }
 
+  /**
+   * Copy-assigns the data into @p out, so e.g. a vector or string reuses the
+   * capacity it already has instead of allocating
+   */
+  template <class U = T, if_copy_assignable<U>* = nullptr>
+  void peek_into(T& out) const {
+    lock_type_t lock(mutex_);
+    out = t_;
+  }
+
+  /**
+   * A copy of the data and its version, or nullopt if the version is still
+   * @p last. Unchanged data is detected without locking or copying. Versions
+   * start at 1, so pass 0 the first time
+   */
+  template <class U = T, if_copy_constructible<U>* = nullptr>
+  std::optional<std::pair<T, version_type>> peek_if_newer(
+      version_type last) const {
+    if (version() == last) {
+      return std::nullopt;
+    }
+    lock_type_t lock(mutex_);
+    const auto current = signal_.version();
+    if (current == last) {
+      return std::nullopt;
+    }
+    return std::pair<T, version_type>{t_, current};
+  }
+
+  /** bumped by every mutation, readable without the lock */
+  version_type version() const noexcept { return signal_.version(); }
+
   // mutate data ---------------------------------------------------------------
 
-  template <class U = T, class = if_assignable<T, U&&>>
+  template <class U = T, class = if_assignable<T&, U&&>>
   void push(U&& u) {
+    notifier notify{signal_};
     lock_type_t lock(mutex_);
+    notify.changed();
     t_ = std::forward<U>(u);
   }
 
+  /**
+   * Like push, but returns false straight away if the mutex is taken, leaving
+   * @p u untouched
+   */
+  template <class U = T, class = if_assignable<T&, U&&>>
+  bool try_push(U&& u) {
+    notifier notify{signal_};
+    try_lock_type_t lock(mutex_, std::try_to_lock);
+    if (!lock) {
+      return false;
+    }
+    notify.changed();
+    t_ = std::forward<U>(u);
+    return true;
+  }
+
+  // swap data -----------------------------------------------------------------
+
+  /** replaces the data with @p u, and returns the old data by move */
+  template <class U = T, class = if_assignable<T&, U&&>>
+  T exchange(U&& u) {
+    notifier notify{signal_};
+    lock_type_t lock(mutex_);
+    notify.changed();
+    return std::exchange(t_, std::forward<U>(u));
+  }
+
+  /** moves the data out, leaving a default constructed T behind */
+  template <class U = T, if_default_constructible<U>* = nullptr>
+  T take() {
+    return exchange(T{});
+  }
+
+  /**
+   * Replaces the data with @p desired if it compares equal to @p expected.
+   * Otherwise copies the current data into @p expected, like std::atomic
+   */
+  template <class U = T, class V = T,
+            class = If<std::is_copy_assignable_v<V> &&
+                       std::is_assignable_v<V&, U&&>>>
+  bool compare_exchange(T& expected, U&& desired) {
+    notifier notify{signal_};
+    lock_type_t lock(mutex_);
+    if (!(t_ == expected)) {
+      expected = t_;
+      return false;
+    }
+    notify.changed();
+    t_ = std::forward<U>(desired);
+    return true;
+  }
+
+  /**
+   * Replaces the data with @p desired if it compares equal to @p expected.
+   * Works with move-only types, since @p expected is left untouched
+   */
+  template <class U = T, class = if_assignable<T&, U&&>>
+  bool compare_exchange(const T& expected, U&& desired) {
+    notifier notify{signal_};
+    lock_type_t lock(mutex_);
+    if (!(t_ == expected)) {
+      return false;
+    }
+    notify.changed();
+    t_ = std::forward<U>(desired);
+    return true;
+  }
+
   // execute arbitary function on data -----------------------------------------
 
   template <class F>
@@ -66,15 +205,137 @@ class atomic_base {
     return std::invoke(std::forward<F>(f), static_cast<const T&>(t_));
   }
 
+  /** wakes waiters afterwards, in case @p f changed the data */
   template <class F>
   auto apply(F&& f) {
+    notifier notify{signal_};
     lock_type_t lock(mutex_);
+    notify.changed();
     return std::invoke(std::forward<F>(f), static_cast<T&>(t_));
   }
 
+  // execute function only if the lock is free ---------------------------------
+
+  /**
+   * Like apply, but doesn't wait if the mutex is taken. Returns whether @p f
+   * ran if it returns void, otherwise its result or nullopt
+   */
+  template <class F>
+  auto try_apply(F&& f) const {
+    try_lock_type_t lock(mutex_, std::try_to_lock);
+    return apply_if_owned(lock, std::forward<F>(f));
+  }
+
+  template <class F>
+  auto try_apply(F&& f) {
+    notifier notify{signal_};
+    try_lock_type_t lock(mutex_, std::try_to_lock);
+    return apply_if_owned(notify, lock, std::forward<F>(f));
+  }
+
+  /** like try_apply, but waits up to @p timeout for the mutex */
+  template <class F, class Rep, class Period>
+  auto try_apply_for(F&& f,
+                     const std::chrono::duration<Rep, Period>& timeout) const {
+    try_lock_type_t lock(mutex_, timeout);
+    return apply_if_owned(lock, std::forward<F>(f));
+  }
+
+  template <class F, class Rep, class Period>
+  auto try_apply_for(F&& f, const std::chrono::duration<Rep, Period>& timeout) {
+    notifier notify{signal_};
+    try_lock_type_t lock(mutex_, timeout);
+    return apply_if_owned(notify, lock, std::forward<F>(f));
+  }
+
+#ifdef NIL_ASYNC_COROUTINES
+  // execute function from a coroutine -----------------------------------------
+
+  /**
+   * Like apply, but co_awaiting it suspends the coroutine until the lock is
+   * free instead of blocking the thread. Needs an async::async_mutex. @p f is
+   * moved into the task, which must not outlive this
+   */
+  template <class F>
+  async::task<std::decay_t<std::invoke_result_t<F&, const T&>>> apply_async(
+      F f) const {
+    co_await mutex_.lock_async();
+    lock_type_t lock(mutex_, std::adopt_lock);
+    co_return std::invoke(f, static_cast<const T&>(t_));
+  }
+
+  template <class F>
+  async::task<std::decay_t<std::invoke_result_t<F&, T&>>> apply_async(F f) {
+    notifier notify{signal_};
+    co_await mutex_.lock_async();
+    lock_type_t lock(mutex_, std::adopt_lock);
+    notify.changed();
+    co_return std::invoke(f, static_cast<T&>(t_));
+  }
+#endif
+
+  // wait for a change ---------------------------------------------------------
+
+  /**
+   * Blocks until @p pred returns true for the data. @p pred is checked with the
+   * lock held, first straight away and then after every push or apply
+   */
+  template <class Pred, class = if_invocable<Pred, const T&>>
+  void wait_until(Pred&& pred) const {
+    signal_.wait_until<lock_type_t>(mutex_, ready(pred));
+  }
+
+  /** like wait_until, but gives up after @p timeout. Returns false if it did */
+  template <class Pred, class Rep, class Period,
+            class = if_invocable<Pred, const T&>>
+  bool wait_for(Pred&& pred,
+                const std::chrono::duration<Rep, Period>& timeout) const {
+    using clock = async::change_signal::clock;
+    const auto deadline =
+        clock::now() + std::chrono::duration_cast<clock::duration>(timeout);
+    return signal_.wait_until<lock_type_t>(mutex_, ready(pred), deadline);
+  }
+
+  // instrumentation -----------------------------------------------------------
+
+  /**
+   * Names this instance in the lock_registry. Only compiles if the mutex
+   * supports it, like instrumented_mutex
+   */
+  void set_lock_name(const std::string& name) { mutex_.set_name(name); }
+
  private:
-  mutable mutex_type mutex_;
-  T t_;
+  friend struct async::detail::lock_access;  //!< for apply_all
+
+  using notifier = async::change_signal::notifier;
+
+  template <class F>
+  auto apply_if_owned(const try_lock_type_t& lock, F&& f) const {
+    return async::detail::invoke_if_owned(lock, std::forward<F>(f),
+                                          static_cast<const T&>(t_));
+  }
+
+  /** counts as a change if the lock was taken, like apply */
+  template <class F>
+  auto apply_if_owned(notifier& notify, const try_lock_type_t& lock, F&& f) {
+    if (lock) {
+      notify.changed();
+    }
+    return async::detail::invoke_if_owned(lock, std::forward<F>(f),
+                                          static_cast<T&>(t_));
+  }
+
+  /** @p pred bound to the data, to be called with the lock held */
+  template <class Pred>
+  auto ready(Pred& pred) const {
+    return [this, &pred]() {
+      return static_cast<bool>(std::invoke(pred, static_cast<const T&>(t_)));
+    };
+  }
+
+  alignas(Layout::mutex_alignment) alignas(Mutex) mutable mutex_type mutex_;
+  mutable async::change_signal signal_;  //!< version, wakes waiters
+  alignas(Layout::data_alignment) alignas(T) T t_;
 };
 
 }  // namespace nil
@@ -0,0 +1,19 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_ATOMICRCU_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_ATOMICRCU_HPP_
+
+#include <mutex>
+
+#include "async/atomic_rcu_base.hpp"
+
+namespace nil {
+
+/**
+ * Specialized for std::mutex with std::unique_lock for writers. Readers never
+ * lock regardless of the mutex type.
+ */
+template <class T>
+using atomic_rcu = atomic_rcu_base<T, std::mutex, std::unique_lock>;
+
+}  // namespace nil
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_ATOMICRCU_HPP_
@@ -0,0 +1,101 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_ATOMICRCUBASE_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_ATOMICRCUBASE_HPP_
+
+#include <functional>
+#include <memory>
+#include <meta/enable_if.hpp>
+
+#include "async/atomic_rcu_proxy.hpp"
+
+namespace nil {
+
+/**
+ * Read-copy-update alternative to atomic_rw_base for read-mostly data.
+ *
+ * Readers get an immutable, refcounted snapshot of the current version and
+ * never block, not even while a write is in progress: loading it is lock-free,
+ * see rcu_pointer. Writers are serialized with a mutex; they clone the current
+ * version, mutate the clone and publish it atomically. Old versions are freed
+ * once the last reader drops them.
+ *
+ * The trade-off is that every write copies T, and readers holding a snapshot
+ * won't see later writes until they call read() again.
+ *
+ * @note same as atomic_rw_base, calling write() twice from the same thread
+ * within the same scope will cause deadlock
+ *
+ * @tparam T - any copyable type
+ * @tparam Mutex - a standard mutex, like std::mutex, for serializing writers
+ * @tparam WriteLock - a movable RAII lock with unlock(), like std::unique_lock
+ */
+template <class T, class Mutex, template <class> class WriteLock>
+class atomic_rcu_base {
+  static_assert(std::is_copy_constructible_v<T>, "T must be copyable");
+
+ public:
+  using value_type = T;
+  using mutex_type = Mutex;
+  using write_lock = WriteLock<Mutex>;
+  using snapshot_type = std::shared_ptr<const T>;
+  using write_proxy_t = atomic_rcu_proxy<T, mutex_type, WriteLock>;
+
+  // constructors --------------------------------------------------------------
+
+  template <class U = T, if_default_constructible<U>* = nullptr>
+  atomic_rcu_base() : current_{std::make_shared<const T>()} {}
+
+  template <class... Args>
+  atomic_rcu_base(Args&&... args)
+      : current_{std::make_shared<const T>(T{std::forward<Args>(args)...})} {}
+
+  // deleted copy and move constructors and assignment -------------------------
+
+  atomic_rcu_base(const atomic_rcu_base&) = delete;
+  atomic_rcu_base& operator=(const atomic_rcu_base&) = delete;
+  atomic_rcu_base(atomic_rcu_base&&) = delete;
+  atomic_rcu_base& operator=(atomic_rcu_base&&) = delete;
+
+  // some convenience functions ------------------------------------------------
+
+  T copy() const { return *current_.load(); }
+
+  template <class... Args>
+  void assign(Args&&... args) {
+    auto next = current_.stage(
+        std::make_shared<const T>(T{std::forward<Args>(args)...}));
+    {
+      write_lock lock{mutex_};
+      current_.publish(std::move(next));
+    }
+    current_.reclaim();
+  }
+
+  // get a snapshot ------------------------------------------------------------
+
+  snapshot_type operator*() const { return current_.load(); }
+  snapshot_type operator->() const { return current_.load(); }
+  snapshot_type read() const { return current_.load(); }
+
+  // get write proxy -----------------------------------------------------------
+
+  /** clones the current version, which is published when the proxy dies */
+  write_proxy_t write() { return write_proxy_t{write_lock(mutex_), current_}; }
+
+  /**
+   * clones, invokes @p f on the clone and publishes it, returns f's result. If
+   * @p f throws, the clone is dropped and nothing is published
+   */
+  template <class F, class = if_invocable<F, T&>>
+  auto update(F&& f) {
+    auto proxy = write();
+    return std::invoke(std::forward<F>(f), *proxy);
+  }
+
+ private:
+  mutable mutex_type mutex_;
+  rcu_pointer<T> current_;
+};
+
+}  // namespace nil
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_ATOMICRCUBASE_HPP_
@@ -0,0 +1,188 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_ATOMICRCUPROXY_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_ATOMICRCUPROXY_HPP_
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <utility>
+
+#include "async/hazard_domain.hpp"
+
+namespace nil {
+
+/**
+ * Holder for the currently published version of an atomic_rcu_base. Readers
+ * atomically load a refcounted snapshot, writers atomically replace it.
+ *
+ * The snapshot sits in a node behind a plain atomic pointer. Readers protect
+ * the node with a hazard pointer just long enough to copy the snapshot out, so
+ * loading is lock-free. std::atomic_load on a std::shared_ptr, and
+ * std::atomic<std::shared_ptr> in libstdc++, both take a lock instead.
+ *
+ * Writers stage the next node up front, publish it under their lock (which
+ * can't fail), and reclaim the replaced nodes once the lock is released. They
+ * are retired to hazard_domain::global() and collected straight away, so an
+ * old version is still freed once the last reader drops it
+ */
+template <class T>
+class rcu_pointer {
+ public:
+  using snapshot_type = std::shared_ptr<const T>;
+
+ private:
+  struct node {
+    snapshot_type snapshot;
+    node* next{nullptr};  //!< in replaced_, once it's been replaced
+  };
+
+ public:
+  using staged = std::unique_ptr<node>;  //!< a version not yet published
+
+  explicit rcu_pointer(snapshot_type p)
+      : domain_{async::hazard_domain::global()},
+        node_{new node{std::move(p)}} {}
+
+  /** no reader may be loading any more */
+  ~rcu_pointer() {
+    delete node_.load(std::memory_order_relaxed);
+    delete_all(replaced_.load(std::memory_order_relaxed));
+  }
+
+  rcu_pointer(const rcu_pointer&) = delete;
+  rcu_pointer& operator=(const rcu_pointer&) = delete;
+
+  snapshot_type load() const {
+    auto guard = domain_.pin();
+    return guard.protect(node_)->snapshot;
+  }
+
+  /** allocates the node for @p p, before taking the writer lock */
+  static staged stage(snapshot_type p) {
+    return staged{new node{std::move(p)}};
+  }
+
+  /**
+   * Replaces the current version with @p next, with the writer lock held. The
+   * old one waits for reclaim()
+   */
+  void publish(staged next) noexcept {
+    auto* old = node_.exchange(next.release(), std::memory_order_acq_rel);
+    push_replaced(old, old);
+  }
+
+  /**
+   * Retires the nodes publish() replaced and frees whatever no reader holds.
+   * This allocates, so it's called after the writer lock is released. If it
+   * runs out of memory, the rest are left for the next writer
+   */
+  void reclaim() noexcept {
+    auto* n = replaced_.exchange(nullptr, std::memory_order_acquire);
+    try {
+      for (; n; n = n->next) {
+        domain_.retire(n);
+      }
+      domain_.collect();
+    } catch (...) {
+      if (n) {
+        auto* last = n;
+        while (last->next) {
+          last = last->next;
+        }
+        push_replaced(n, last);
+      }
+    }
+  }
+
+ private:
+  /** pushes the list from @p first to @p last, linked by next */
+  void push_replaced(node* first, node* last) noexcept {
+    last->next = replaced_.load(std::memory_order_relaxed);
+    while (!replaced_.compare_exchange_weak(last->next, first,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+    }
+  }
+
+  static void delete_all(node* n) noexcept {
+    while (n) {
+      delete std::exchange(n, n->next);
+    }
+  }
+
+  async::hazard_domain& domain_;  //!< constructed before us, so outlives us
+  std::atomic<node*> node_;
+  std::atomic<node*> replaced_{nullptr};  //!< not yet retired
+};
+
+/**
+ * @note this class is returned by atomic_rcu_base and should not be used
+ * directly
+ *
+ * Captures the writer lock and a private clone of the current version.
+ * Provides pointer-like access to the clone, and publishes it on destruction.
+ * Readers keep seeing the previous version until then. If the proxy is
+ * destroyed by an exception, the clone is dropped instead, so a half-finished
+ * write is never seen.
+ *
+ * @note the instance of this class must NOT outlive the original atomic class
+ */
+template <class T, class Mutex, template <class> class WriteLock>
+class atomic_rcu_proxy {
+ public:
+  using value_type = T;
+  using mutex_type = Mutex;
+  using write_lock = WriteLock<Mutex>;
+
+  atomic_rcu_proxy() = delete;  //!< must be initialized with a lock and data
+
+  /** takes ownership of write lock, clones the current version */
+  atomic_rcu_proxy(write_lock&& lk, rcu_pointer<T>& current)
+      : lk_{std::move(lk)},
+        current_{current},
+        next_{std::make_shared<T>(*current.load())},
+        staged_{current.stage(next_)} {}
+
+  atomic_rcu_proxy(const atomic_rcu_proxy&) = delete;
+  atomic_rcu_proxy& operator=(const atomic_rcu_proxy&) = delete;
+  atomic_rcu_proxy(atomic_rcu_proxy&&) = default;
+  atomic_rcu_proxy& operator=(atomic_rcu_proxy&&) = delete;
+
+  /**
+   * publishes the modified clone unless an exception is unwinding through the
+   * write, releases the writer lock, then reclaims the old version
+   */
+  ~atomic_rcu_proxy() {
+    if (!staged_) {
+      return;  // moved from
+    }
+    if (std::uncaught_exceptions() == exceptions_) {
+      current_.publish(std::move(staged_));
+    }
+    lk_.unlock();
+    current_.reclaim();
+  }
+
+  // pointer like const and non-const access to data ---------------------------
+
+  T& operator*() { return *next_; }
+  const T& operator*() const { return *next_; }
+
+  T* operator->() { return next_.get(); }
+  const T* operator->() const { return next_.get(); }
+
+  // function style const and non-const access to data -------------------------
+
+  T& value() & { return *next_; }
+  const T& value() const& { return *next_; }
+
+ private:
+  write_lock lk_;
+  rcu_pointer<T>& current_;
+  std::shared_ptr<T> next_;  //!< the clone, also owned by staged_
+  typename rcu_pointer<T>::staged staged_;
+  int exceptions_{std::uncaught_exceptions()};  //!< in flight when created
+};
+
+}  // namespace nil
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_ATOMICRCUPROXY_HPP_
@@ -1,6 +1,7 @@
 #ifndef NIL_SRC_THREADSAFE_INC_THREADSAFE_RWATOMIC_HPP_
 #define NIL_SRC_THREADSAFE_INC_THREADSAFE_RWATOMIC_HPP_
 
+#include <mutex>
 #include <shared_mutex>
 
 #include "async/atomic_rw_base.hpp"
@@ -16,6 +17,15 @@ template <class T>
 using atomic_rw =
     atomic_rw_base<T, std::shared_mutex, std::unique_lock, std::shared_lock>;
 
+/**
+ * nil::atomic_rw with a std::timed_mutex upgrade gate, for upgradeable_read.
+ * Every writer takes the gate too, so only use it if something upgrades
+ */
+template <class T>
+using atomic_rw_upgradeable =
+    atomic_rw_base<T, std::shared_mutex, std::unique_lock, std::shared_lock,
+                   async::layout::compact, std::timed_mutex>;
+
 }  // namespace nil
 
 #endif  // NIL_SRC_THREADSAFE_INC_THREADSAFE_RWATOMIC_HPP_
@@ -8,12 +8,35 @@
 #ifndef NIL_SRC_ASYNC_INC_ASYNC_ATOMICRWBASE_HPP_
 #define NIL_SRC_ASYNC_INC_ASYNC_ATOMICRWBASE_HPP_
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <meta/enable_if.hpp>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
 
 #include "async/atomic_rw_proxy.hpp"
+#include "async/layout.hpp"
+#include "async/lock_access.hpp"
 
 namespace nil {
 
+namespace async::detail {
+
+/** the upgrade gate of atomic_rw_base, a base so it takes no space if void */
+template <class UpgradeMutex>
+struct upgrade_gate {
+  UpgradeMutex upgrade_mutex_;
+};
+
+template <>
+struct upgrade_gate<void> {};
+
+}  // namespace async::detail
+
 /**
  * Wraps any type T with a reader-writer mutex. Provides read-only and write
  * access to the underlying type.
@@ -24,28 +47,56 @@ namespace nil {
  * The provides terse, pointer-like symantics for reading. Writing requires a
  * slightly more verbose function call to mark it as a more expensive operation
  *
+ * With an UpgradeMutex, upgradeable_read() returns a read proxy which can
+ * later be upgraded to a write proxy atomically. To make that possible,
+ * writers and upgraders first pass through that separate upgrade gate, so only
+ * one of them is ever waiting on the exclusive lock at a time. Without one
+ * (the default), writers only take the exclusive lock.
+ *
+ * try_read and try_write return nullopt instead of waiting if the lock is
+ * taken, so latency-critical threads can skip or defer the work. The _for
+ * variants wait up to a timeout, which needs a timed mutex like
+ * std::shared_timed_mutex
+ *
+ * Every write bumps a version, which can be read without the lock.
+ * copy_if_newer only copies the data if the version moved on since the caller
+ * last looked
+ *
  * @note calling write() twice from the same thread within the same scope will
- * cause deadlock (or undefined behaviour)
+ * cause deadlock (or undefined behaviour). So will calling write() or
+ * upgradeable_read() while holding an upgradeable read proxy
  *
- * @tparam T - any copyable type
+ * @tparam T - any movable type. copy and copy_if_newer need it to be copyable
  * @tparam SharedMutex - a reader-writer mutex, like std::shared_mutex
  * @tparam WriteLock - an RAII unique lock, like std::unique_lock
  * @tparam ReadLock - an RAII shared lock, like std::shared_lock
+ * @tparam Layout - one of the nil::async::layout policies, defaults to compact
+ * @tparam UpgradeMutex - the upgrade gate, like std::timed_mutex, or void for
+ * none. Only needed for upgradeable_read
  */
-template <class T,                           //
-          class SharedMutex,                 //
-          template <class> class WriteLock,  //
-          template <class> class ReadLock>
-class atomic_rw_base {
-  static_assert(std::is_copy_constructible_v<T>, "T must be copyable");
-
+template <class T,                                //
+          class SharedMutex,                      //
+          template <class> class WriteLock,       //
+          template <class> class ReadLock,        //
+          class Layout = async::layout::compact,  //
+          class UpgradeMutex = void>
+class atomic_rw_base : private async::detail::upgrade_gate<UpgradeMutex> {
  public:
   using value_type = T;
   using mutex_type = SharedMutex;
   using write_lock = WriteLock<SharedMutex>;
   using read_lock = ReadLock<SharedMutex>;
+  using layout_type = Layout;
+  using version_type = std::uint64_t;
   using read_proxy_t = atomic_r_proxy<T, mutex_type, ReadLock>;
   using write_proxy_t = atomic_rw_proxy<T, mutex_type, WriteLock>;
+  using upgrade_mutex_type = UpgradeMutex;
+  using upgrade_lock = std::unique_lock<UpgradeMutex>;
+  using upgradeable_proxy_t =
+      atomic_upgradeable_proxy<T, mutex_type, WriteLock, ReadLock,
+                               UpgradeMutex>;
+
+  static constexpr bool is_upgradeable = !std::is_void_v<UpgradeMutex>;
 
   // constructors --------------------------------------------------------------
 
@@ -64,17 +115,94 @@ class atomic_rw_base {
 
   // some convenience functions ------------------------------------------------
 
+  template <class U = T, if_copy_constructible<U>* = nullptr>
   T copy() const {
     read_lock lock{mutex_};
     return t_;
   }
 
+  /** copy-assigns the data into @p out, reusing whatever storage it has */
+  template <class U = T, if_copy_assignable<U>* = nullptr>
+  void copy_into(T& out) const {
+    read_lock lock{mutex_};
+    out = t_;
+  }
+
+  /**
+   * A copy of the data and its version, or nullopt if the version is still
+   * @p last. Unchanged data is detected without locking or copying. Versions
+   * start at 1, so pass 0 the first time
+   */
+  template <class U = T, if_copy_constructible<U>* = nullptr>
+  std::optional<std::pair<T, version_type>> copy_if_newer(
+      version_type last) const {
+    if (version() == last) {
+      return std::nullopt;
+    }
+    read_lock lock{mutex_};
+    const auto current = version_.load(std::memory_order_relaxed);
+    if (current == last) {
+      return std::nullopt;
+    }
+    return std::pair<T, version_type>{t_, current};
+  }
+
   template <class... Args>
   void assign(Args&&... args) {
-    write_lock lock{mutex_};
+    auto lock = lock_for_write();
+    changed();
     t_ = {std::forward<Args>(args)...};
   }
 
+  // swap data -----------------------------------------------------------------
+
+  /** replaces the data with @p u, and returns the old data by move */
+  template <class U = T, class = if_assignable<T&, U&&>>
+  T exchange(U&& u) {
+    auto lock = lock_for_write();
+    changed();
+    return std::exchange(t_, std::forward<U>(u));
+  }
+
+  /** moves the data out, leaving a default constructed T behind */
+  template <class U = T, if_default_constructible<U>* = nullptr>
+  T take() {
+    return exchange(T{});
+  }
+
+  /**
+   * Replaces the data with @p desired if it compares equal to @p expected.
+   * Otherwise copies the current data into @p expected, like std::atomic
+   */
+  template <class U = T, class V = T,
+            class = If<std::is_copy_assignable_v<V> &&
+                       std::is_assignable_v<V&, U&&>>>
+  bool compare_exchange(T& expected, U&& desired) {
+    auto lock = lock_for_write();
+    if (!(t_ == expected)) {
+      expected = t_;
+      return false;
+    }
+    changed();
+    t_ = std::forward<U>(desired);
+    return true;
+  }
+
+  /**
+   * Replaces the data with @p desired if it compares equal to @p expected.
+   * Works with move-only types, since @p expected is left untouched
+   */
+  template <class U = T, class = if_assignable<T&, U&&>>
+  bool compare_exchange(const T& expected, U&& desired) {
+    auto lock = lock_for_write();
+    if (!(t_ == expected)) {
+      return false;
+    }
+    changed();
+    t_ = std::forward<U>(desired);
+    return true;
+  }
+
   // get read proxy ------------------------------------------------------------
 
   auto operator*() const { return read_proxy_t{read_lock(mutex_), t_}; }
@@ -83,11 +211,126 @@ class atomic_rw_base {
 
   // get write proxy -----------------------------------------------------------
 
-  auto write() { return write_proxy_t{write_lock(mutex_), t_}; }
+  auto write() {
+    auto lock = lock_for_write();
+    changed();
+    return write_proxy_t{std::move(lock), t_};
+  }
+
+  // try to get a proxy without waiting ----------------------------------------
+
+  /** a read proxy, or nullopt if a writer holds the lock */
+  std::optional<read_proxy_t> try_read() const {
+    return try_read_with(std::try_to_lock);
+  }
+
+  /** a write proxy, or nullopt if anyone holds the lock */
+  std::optional<write_proxy_t> try_write() {
+    return try_write_with(std::try_to_lock);
+  }
+
+  /** like try_read, but waits up to @p timeout for the lock */
+  template <class Rep, class Period>
+  std::optional<read_proxy_t> try_read_for(
+      const std::chrono::duration<Rep, Period>& timeout) const {
+    return try_read_with(std::chrono::steady_clock::now() + timeout);
+  }
+
+  /** like try_write, but waits up to @p timeout for the lock */
+  template <class Rep, class Period>
+  std::optional<write_proxy_t> try_write_for(
+      const std::chrono::duration<Rep, Period>& timeout) {
+    return try_write_with(std::chrono::steady_clock::now() + timeout);
+  }
+
+  // get upgradeable read proxy ------------------------------------------------
+
+  /**
+   * Read access that coexists with plain readers, but excludes writers and
+   * other upgraders, so it can be upgraded to write access without anything
+   * changing in between. Only available with an UpgradeMutex
+   */
+  template <class G = UpgradeMutex, if_not_void<G>* = nullptr>
+  auto upgradeable_read() {
+    upgrade_lock gate{this->upgrade_mutex_};
+    return upgradeable_proxy_t{std::move(gate), read_lock(mutex_), t_,
+                               &version_};
+  }
+
+  // state observers -----------------------------------------------------------
+
+  /**
+   * Bumped whenever write access is handed out (write and upgrade) and by
+   * every successful assign, exchange or compare_exchange. Readable without
+   * the lock
+   */
+  version_type version() const noexcept {
+    return version_.load(std::memory_order_acquire);
+  }
+
+  // instrumentation -----------------------------------------------------------
+
+  /**
+   * Names this instance in the lock_registry. Only compiles if the mutex
+   * supports it, like instrumented_mutex
+   */
+  void set_lock_name(const std::string& name) { mutex_.set_name(name); }
 
  private:
-  mutable mutex_type mutex_;
-  T t_;
+  friend struct async::detail::lock_access;  //!< for apply_all
+
+  /** writers wait behind upgraders, so they can't sneak in on an upgrade */
+  write_lock lock_for_write() {
+    if constexpr (is_upgradeable) {
+      std::lock_guard<UpgradeMutex> gate{this->upgrade_mutex_};
+      return write_lock{mutex_};
+    } else {
+      return write_lock{mutex_};
+    }
+  }
+
+  /** @p how is std::try_to_lock or a deadline */
+  template <class How>
+  std::optional<read_proxy_t> try_read_with(const How& how) const {
+    read_lock lock{mutex_, how};
+    if (!lock.owns_lock()) {
+      return std::nullopt;
+    }
+    return read_proxy_t{std::move(lock), t_};
+  }
+
+  /** like lock_for_write, but gives up as @p how says */
+  template <class How>
+  std::optional<write_proxy_t> try_write_with(const How& how) {
+    if constexpr (is_upgradeable) {
+      upgrade_lock gate{this->upgrade_mutex_, how};
+      if (!gate.owns_lock()) {
+        return std::nullopt;
+      }
+      return try_lock_write(how);
+    } else {
+      return try_lock_write(how);
+    }
+  }
+
+  /** the exclusive part of try_write_with */
+  template <class How>
+  std::optional<write_proxy_t> try_lock_write(const How& how) {
+    write_lock lock{mutex_, how};
+    if (!lock.owns_lock()) {
+      return std::nullopt;
+    }
+    changed();
+    return write_proxy_t{std::move(lock), t_};
+  }
+
+  /** must be called with the write lock held */
+  void changed() noexcept { version_.fetch_add(1, std::memory_order_release); }
+
+  alignas(Layout::mutex_alignment) alignas(SharedMutex)  //
+      mutable mutex_type mutex_;
+  std::atomic<version_type> version_{1};  //!< only bumped under the write lock
+  alignas(Layout::data_alignment) alignas(T) T t_;
 };
 
 }  // namespace nil
@@ -1,6 +1,11 @@
 #ifndef NIL_SRC_THREADSAFE_INC_THREADSAFE_ATOMICRWPROXY_HPP_
 #define NIL_SRC_THREADSAFE_INC_THREADSAFE_ATOMICRWPROXY_HPP_
 
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
 namespace nil {
 
 /**
@@ -75,6 +80,78 @@ class atomic_rw_proxy {
   T& t_;
 };
 
+/**
+ * A read proxy that can be promoted to a write proxy without letting another
+ * writer in between, for check-then-update code.
+ *
+ * Holds the atomic's upgrade gate, an UpgradeMutex (excluding other upgraders
+ * and writers), and a shared lock (coexisting with plain readers). upgrade()
+ * swaps the shared lock for the exclusive one while still holding the gate, so
+ * nothing can change the data in between, and returns a regular
+ * atomic_rw_proxy.
+ *
+ * @note same as atomic_r_proxy, this should not be constructed directly
+ * @note same as atomic_r_proxy, this must NOT outlive the original atomic class
+ */
+template <class T, class SharedMutex, template <class> class WriteLock,
+          template <class> class ReadLock, class UpgradeMutex>
+class atomic_upgradeable_proxy {
+ public:
+  using value_type = T;
+  using mutex_type = SharedMutex;
+  using write_lock = WriteLock<SharedMutex>;
+  using read_lock = ReadLock<SharedMutex>;
+  using upgrade_lock = std::unique_lock<UpgradeMutex>;
+  using write_proxy_t = atomic_rw_proxy<T, SharedMutex, WriteLock>;
+
+  atomic_upgradeable_proxy() = delete;  //!< must have both locks
+
+  /**
+   * Takes ownership of both locks, @p upgrade_lk must be taken first. If
+   * given, @p version is bumped on upgrade
+   */
+  atomic_upgradeable_proxy(upgrade_lock&& upgrade_lk, read_lock&& read_lk,
+                           T& t, std::atomic<std::uint64_t>* version = nullptr)
+      : upgrade_lk_{std::move(upgrade_lk)},
+        read_lk_{std::move(read_lk)},
+        t_{t},
+        version_{version} {}
+
+  // pointer-like access -------------------------------------------------------
+
+  const T& operator*() const { return t_; }
+  const T* operator->() const { return &t_; }
+
+  // function style access -----------------------------------------------------
+
+  const T& value() const { return t_; }
+
+  // upgrade -------------------------------------------------------------------
+
+  /**
+   * Waits for the plain readers to leave, and returns a write proxy. The data
+   * is guaranteed to be unchanged since this proxy was created.
+   *
+   * @note this proxy must not be used afterwards
+   */
+  write_proxy_t upgrade() && {
+    auto& mutex = *read_lk_.mutex();
+    read_lk_.unlock();
+    write_lock lk{mutex};
+    if (version_) {
+      version_->fetch_add(1, std::memory_order_release);
+    }
+    upgrade_lk_.unlock();  // writers queue on the exclusive lock from here
+    return write_proxy_t{std::move(lk), t_};
+  }
+
+ private:
+  upgrade_lock upgrade_lk_;
+  read_lock read_lk_;
+  T& t_;
+  std::atomic<std::uint64_t>* version_;
+};
+
 }  // namespace nil
 
 #endif  // NIL_SRC_THREADSAFE_INC_THREADSAFE_ATOMICRWPROXY_HPP_
@@ -0,0 +1,23 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_ATOMICRWSCALABLE_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_ATOMICRWSCALABLE_HPP_
+
+#include <mutex>
+#include <shared_mutex>
+
+#include "async/atomic_rw_base.hpp"
+#include "async/distributed_shared_mutex.hpp"
+
+namespace nil {
+
+/**
+ * Specialized for nil::async::distributed_shared_mutex. Same API as
+ * nil::atomic_rw, but read throughput keeps scaling with the number of reader
+ * threads, at the cost of more expensive writes
+ */
+template <class T>
+using atomic_rw_scalable = atomic_rw_base<T, async::distributed_shared_mutex,
+                                          std::unique_lock, std::shared_lock>;
+
+}  // namespace nil
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_ATOMICRWSCALABLE_HPP_
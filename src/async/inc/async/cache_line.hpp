@@ -0,0 +1,24 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_CACHELINE_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_CACHELINE_HPP_
+
+#include <cstddef>
+
+namespace nil::async {
+
+/**
+ * Alignment used to keep independently written data on separate cache lines.
+ *
+ * @note std::hardware_destructive_interference_size can change with compiler
+ * flags, which would silently change the layout (and ABI) of every class using
+ * it, so a fixed value is used instead. 64 bytes is right for x86-64 and most
+ * ARM cores. Define NIL_ASYNC_CACHE_LINE_SIZE to override it.
+ */
+#ifdef NIL_ASYNC_CACHE_LINE_SIZE
+inline constexpr std::size_t cache_line_size = NIL_ASYNC_CACHE_LINE_SIZE;
+#else
+inline constexpr std::size_t cache_line_size = 64;
+#endif
+
+}  // namespace nil::async
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_CACHELINE_HPP_
@@ -0,0 +1,203 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_CHANGESIGNAL_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_CHANGESIGNAL_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <climits>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace nil::async {
+
+/**
+ * Lets threads sleep until the data guarded by some other lock is changed.
+ * Used by the wait_until / wait_for functions of atomic_base and
+ * optional_base.
+ *
+ * Mutators record changes with the lock held through a notifier, which wakes
+ * the waiters once the lock is released. Waiters check their predicate with
+ * the lock held, take a ticket with prepare_wait(), release the lock and sleep
+ * in wait() until a change after that ticket. Waking only makes a syscall if
+ * someone was waiting, so mutations cost a plain store otherwise.
+ *
+ * The version and a "someone is waiting" bit share one 64 bit word, so it only
+ * adds 8 bytes to the wrapper. On Linux waiters sleep on a futex, the low 32
+ * bits of that word. Elsewhere it falls back to a condition variable.
+ */
+class change_signal {
+ public:
+  using clock = std::chrono::steady_clock;
+  using version_type = std::uint64_t;
+  using ticket = std::uint64_t;  //!< the word as a waiter last saw it
+
+  change_signal() = default;
+  change_signal(const change_signal&) = delete;
+  change_signal& operator=(const change_signal&) = delete;
+
+  /**
+   * Wakes the waiters on destruction, if changed() was called through it and
+   * anyone was waiting. Declared before the lock so waiters are woken after the
+   * lock is released, and only when something actually changed
+   */
+  class notifier {
+   public:
+    explicit notifier(change_signal& s) noexcept : s_{s} {}
+    ~notifier() {
+      if (wake_) {
+        s_.wake_all();
+      }
+    }
+
+    /** records a change, must be called with the lock held */
+    void changed() noexcept { wake_ = s_.changed() || wake_; }
+
+   private:
+    change_signal& s_;
+    bool wake_{false};
+  };
+
+  /**
+   * Bumped on every change, readable without the lock. Starts at 1, and is 63
+   * bits wide so it doesn't wrap in practice
+   */
+  version_type version() const noexcept {
+    return word_.load(std::memory_order_acquire) >> 1;
+  }
+
+  // must be called with the lock held -----------------------------------------
+
+  /** registers a waiter, pass the result to wait() after unlocking */
+  ticket prepare_wait() noexcept {
+    const auto w = word_.load(std::memory_order_relaxed) | waiting;
+    word_.store(w, std::memory_order_relaxed);
+    return w;
+  }
+
+  // must be called without the lock -------------------------------------------
+
+  /**
+   * Blocks until @p ready returns true, checking it under a @tparam Lock on
+   * @p mutex first and then after every change. Returns false if @p deadline
+   * passes first
+   */
+  template <class Lock, class Mutex, class Ready>
+  bool wait_until(Mutex& mutex, Ready&& ready,
+                  clock::time_point deadline = clock::time_point::max()) {
+    for (;;) {
+      ticket seen;
+      {
+        Lock lock(mutex);
+        if (ready()) {
+          return true;
+        }
+        if (deadline != clock::time_point::max() && clock::now() >= deadline) {
+          return false;
+        }
+        seen = prepare_wait();
+      }
+      wait(seen, deadline);
+    }
+  }
+
+  /**
+   * Sleeps until a change after @p seen, or @p deadline passes. May return
+   * early, so callers re-check their predicate.
+   */
+  void wait(ticket seen,
+            clock::time_point deadline = clock::time_point::max()) {
+    park(seen, deadline);
+  }
+
+ private:
+  static constexpr ticket waiting = 1;  //!< the low bit, set by prepare_wait
+
+  /**
+   * Bumps the version and clears the waiting bit, with the lock held. Returns
+   * whether anyone registered since the last change, and needs waking
+   */
+  bool changed() noexcept {
+    const auto w = word_.load(std::memory_order_relaxed);
+    word_.store((w | waiting) + 1, std::memory_order_release);
+    return (w & waiting) != 0;
+  }
+
+#if defined(__linux__)
+  static_assert(sizeof(std::atomic<ticket>) == sizeof(ticket) &&
+                    std::atomic<ticket>::is_always_lock_free,
+                "futex requires a plain 64 bit word to wait on half of");
+
+  /** the low 32 bits of the word, which change on every bump */
+  int* futex_word() noexcept {
+    auto* word = reinterpret_cast<int*>(&word_);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return word + 1;
+#else
+    return word;
+#endif
+  }
+
+  /** sleeps only if the word is still @p seen */
+  void park(ticket seen, clock::time_point deadline) noexcept {
+    const auto low = static_cast<std::uint32_t>(seen);
+    if (deadline == clock::time_point::max()) {
+      syscall(SYS_futex, futex_word(), FUTEX_WAIT_PRIVATE, low, nullptr,
+              nullptr, 0);
+      return;
+    }
+    const auto left = deadline - clock::now();
+    if (left <= clock::duration::zero()) {
+      return;
+    }
+    const auto ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(left).count();
+    timespec timeout{};
+    timeout.tv_sec = static_cast<time_t>(ns / 1000000000);
+    timeout.tv_nsec = static_cast<long>(ns % 1000000000);
+    syscall(SYS_futex, futex_word(), FUTEX_WAIT_PRIVATE, low, &timeout,
+            nullptr, 0);
+  }
+
+  void wake_all() noexcept {
+    syscall(SYS_futex, futex_word(), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr,
+            nullptr, 0);
+  }
+#else
+  /** sleeps only if the word is still @p seen */
+  void park(ticket seen, clock::time_point deadline) {
+    const auto changed = [this, seen]() {
+      return word_.load(std::memory_order_acquire) != seen;
+    };
+    std::unique_lock<std::mutex> lock{park_mutex_};
+    if (deadline == clock::time_point::max()) {
+      park_cv_.wait(lock, changed);
+    } else {
+      park_cv_.wait_until(lock, deadline, changed);
+    }
+  }
+
+  void wake_all() noexcept {
+    { std::lock_guard<std::mutex> lock{park_mutex_}; }
+    park_cv_.notify_all();
+  }
+
+  std::mutex park_mutex_;
+  std::condition_variable park_cv_;
+#endif
+
+  /** version << 1, plus the waiting bit */
+  std::atomic<ticket> word_{1 << 1};
+};
+
+}  // namespace nil::async
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_CHANGESIGNAL_HPP_
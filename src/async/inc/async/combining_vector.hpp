@@ -0,0 +1,24 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_COMBININGVECTOR_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_COMBININGVECTOR_HPP_
+
+#include <mutex>
+#include <vector>
+
+#include "async/container_base.hpp"
+#include "async/flat_combining_mutex.hpp"
+
+namespace nil::async {
+
+/**
+ * Partially specified alias when using container_base with std::vector,
+ * flat_combining_mutex and std::lock_guard. Prefer this over vector when many
+ * threads mutate it at once, like a shared log or work list
+ */
+template <class T, class... Params>
+using combining_vector =
+    container_base<std::vector<T, Params...>, flat_combining_mutex,
+                   std::lock_guard>;
+
+}  // namespace nil::async
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_COMBININGVECTOR_HPP_
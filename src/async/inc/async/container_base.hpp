@@ -1,7 +1,26 @@
 #ifndef NIL_SRC_ASYNC_INC_ASYNC_CONTAINER_HPP_
 #define NIL_SRC_ASYNC_INC_ASYNC_CONTAINER_HPP_
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <string>
+
 #include "async/container_traits.hpp"
+#include "async/layout.hpp"
+#include "async/lock_access.hpp"
+#include "async/try_result.hpp"
+
+#ifdef NIL_ASYNC_COROUTINES
+#include <type_traits>
+
+#include "async/async_mutex.hpp"
+#include "async/task.hpp"
+#endif
 
 namespace nil::async {
 
@@ -23,11 +42,29 @@ namespace nil::async {
  * @note querying by reference is also not supported for the same reason as
  * above. So at, front and back all return copies
  *
+ * @note the wait_extract_* functions block on a condition variable until an
+ * element is available. Insertions only notify if someone is waiting, and
+ * wake one waiter per element, so they cost nothing extra otherwise
+ *
+ * @note with a combining Mutex, like flat_combining_mutex, mutations are
+ * handed to whichever thread holds the lock and run there in one batch with
+ * everyone else's. Reads still take the lock themselves
+ *
+ * @note the try_* functions give up instead of waiting if the mutex is taken,
+ * so latency-critical threads can skip or defer the work. try_apply_for waits
+ * up to a timeout, which needs a timed mutex like std::timed_mutex
+ *
+ * @note with NIL_ASYNC_COROUTINES and an async_mutex, coroutines can co_await
+ * apply_async and wait_extract_*_async, which suspend the coroutine rather
+ * than the thread until the lock is free, or an element is available
+ *
  * @tparam C - a fully templated STL-Like container, such as std::vector<int>.
  * @tparam Mutex - a standard mutex type, like std::mutex
  * @tparam LockGuard - an RAII lock type, like std::lock_guard
+ * @tparam Layout - one of the nil::async::layout policies, defaults to compact
  */
-template <class C, class Mutex, template <class> class LockGuard>
+template <class C, class Mutex, template <class> class LockGuard,
+          class Layout = layout::compact>
 class container_base {
  public:
   using container_type = C;
@@ -35,6 +72,12 @@ class container_base {
   using size_type = typename container_type::size_type;
   using mutex_type = Mutex;
   using lock_type_t = LockGuard<Mutex>;
+  using wait_lock_type_t = std::unique_lock<Mutex>;
+  using try_lock_type_t = std::unique_lock<Mutex>;
+  using layout_type = Layout;
+  using cv_type = std::conditional_t<std::is_same_v<Mutex, std::mutex>,
+                                     std::condition_variable,
+                                     std::condition_variable_any>;
 
   // traits to detect what type this container is similar to -------------------
 
@@ -70,15 +113,21 @@ class container_base {
 
   template <class CT = container_type>
   void assign(CT&& ct) {
-    lock_type_t lock{mutex_};
-    c_ = std::forward<CT>(ct);
+    notifier notify{*this, true};
+    locked([&]() {
+      c_ = std::forward<CT>(ct);
+      notify.arm();
+    });
   }
 
   template <class... Args>
   void assign(std::in_place_t, Args&&... args) {
-    lock_type_t lock{mutex_};
-    c_.clear();
-    (c_.emplace_back(std::forward<Args>(args)), ...);
+    notifier notify{*this, true};
+    locked([&]() {
+      c_.clear();
+      (c_.emplace_back(std::forward<Args>(args)), ...);
+      notify.arm();
+    });
   }
 
   // Access --------------------------------------------------------------------
@@ -107,89 +156,258 @@ class container_base {
     return c_.back();
   }
 
-  // Insertion -----------------------------------------------------------------
+  // Access into caller's storage ----------------------------------------------
 
-  template <class S = size_type, class V = value_type>
-  bool insert(S index, V&& v) {
+  /**
+   * Copy-assigns the element at @p ii into @p out, so it reuses the storage
+   * @p out already has. Returns false, leaving @p out untouched, if there's no
+   * such element
+   */
+  bool at_into(size_type ii, value_type& out) const {
     lock_type_t lock{mutex_};
-    if (index > c_.size()) {
+    if (ii >= c_.size()) {
       return false;
     }
-    c_.insert(std::next(c_.begin(), index), std::forward<V>(v));
+    out = c_.at(ii);
     return true;
   }
 
+  /** like at_into, for the first element */
+  bool front_into(value_type& out) const {
+    lock_type_t lock{mutex_};
+    if (c_.empty()) {
+      return false;
+    }
+    out = c_.front();
+    return true;
+  }
+
+  /** like at_into, for the last element */
+  bool back_into(value_type& out) const {
+    lock_type_t lock{mutex_};
+    if (c_.empty()) {
+      return false;
+    }
+    out = c_.back();
+    return true;
+  }
+
+  // Insertion -----------------------------------------------------------------
+
+  template <class S = size_type, class V = value_type>
+  bool insert(S index, V&& v) {
+    notifier notify{*this};
+    return locked([&]() {
+      if (index > c_.size()) {
+        return false;
+      }
+      c_.insert(std::next(c_.begin(), index), std::forward<V>(v));
+      notify.arm();
+      return true;
+    });
+  }
+
   template <class V = value_type>
   void push_back(V&& v) {
-    lock_type_t lock{mutex_};
-    return c_.push_back(std::forward<V>(v));
+    notifier notify{*this};
+    locked([&]() {
+      c_.push_back(std::forward<V>(v));
+      notify.arm();
+    });
   }
 
   template <class V = value_type>
   void push_front(V&& v) {
-    lock_type_t lock{mutex_};
-    return c_.push_front(std::forward<V>(v));
+    notifier notify{*this};
+    locked([&]() {
+      c_.push_front(std::forward<V>(v));
+      notify.arm();
+    });
+  }
+
+  // Batch insertion -----------------------------------------------------------
+
+  /** appends [first, last) under a single lock acquisition */
+  template <class It>
+  void push_back_range(It first, It last) {
+    notifier notify{*this, true};
+    locked([&]() {
+      c_.insert(c_.end(), first, last);
+      notify.arm();
+    });
+  }
+
+  /**
+   * Appends all elements of @p ct under a single lock acquisition. This is
+   * O(1) if we're empty, or if the container supports splice (like std::list)
+   */
+  void push_back_bulk(container_type&& ct) {
+    notifier notify{*this, true};
+    locked([&]() {
+      if (c_.empty()) {
+        using std::swap;
+        swap(c_, ct);
+      } else if constexpr (exists_v<splice_func, container_type>) {
+        c_.splice(c_.cend(), ct);
+      } else {
+        c_.insert(c_.end(), std::make_move_iterator(ct.begin()),
+                  std::make_move_iterator(ct.end()));
+      }
+      notify.arm();
+    });
   }
 
   // Remove --------------------------------------------------------------------
 
   void clear() {
-    lock_type_t lock{mutex_};
-    c_.clear();
+    locked([&]() { c_.clear(); });
   }
 
   void erase(size_type ii) {
-    lock_type_t lock{mutex_};
-    if (ii >= c_.size()) {
-      return;
-    }
-    c_.erase(std::next(c_.begin(), ii));
+    locked([&]() {
+      if (ii < c_.size()) {
+        c_.erase(std::next(c_.begin(), ii));
+      }
+    });
   }
 
   void pop_back() {
-    lock_type_t lock{mutex_};
-    if (c_.empty()) {
-      return;
-    }
-    c_.pop_back();
+    locked([&]() {
+      if (!c_.empty()) {
+        c_.pop_back();
+      }
+    });
   }
 
   void pop_front() {
-    lock_type_t lock{mutex_};
-    if (c_.empty()) {
-      return;
-    }
-    c_.pop_front();
+    locked([&]() {
+      if (!c_.empty()) {
+        c_.pop_front();
+      }
+    });
   }
 
   std::optional<value_type> extract(size_type ii) {
-    lock_type_t lock{mutex_};
-    if (ii >= c_.size()) {
-      return std::nullopt;
-    }
-    auto v = std::move(c_.at(ii));
-    c_.erase(std::next(c_.begin(), ii));
-    return std::move(v);
+    return locked([&]() -> std::optional<value_type> {
+      if (ii >= c_.size()) {
+        return std::nullopt;
+      }
+      auto v = std::move(c_.at(ii));
+      c_.erase(std::next(c_.begin(), ii));
+      return std::move(v);
+    });
   }
 
   std::optional<value_type> extract_back() {
-    lock_type_t lock{mutex_};
-    if (c_.empty()) {
+    return locked([&]() -> std::optional<value_type> {
+      if (c_.empty()) {
+        return std::nullopt;
+      }
+      return take_back();
+    });
+  }
+
+  std::optional<value_type> extract_front() {
+    return locked([&]() -> std::optional<value_type> {
+      if (c_.empty()) {
+        return std::nullopt;
+      }
+      return take_front();
+    });
+  }
+
+  // Batch remove --------------------------------------------------------------
+
+  /**
+   * Moves up to @p n elements from the front into @p out, under a single lock
+   * acquisition
+   *
+   * @return the number of elements extracted
+   */
+  template <class OutIt>
+  size_type extract_front_n(size_type n, OutIt out) {
+    return locked([&]() {
+      const auto count = std::min(n, c_.size());
+      const auto last = std::next(c_.begin(), count);
+      std::move(c_.begin(), last, out);
+      c_.erase(c_.begin(), last);
+      return count;
+    });
+  }
+
+  /**
+   * Moves every element into @p out. The contents are swapped out in O(1)
+   * under the lock, and moved into @p out after it's released
+   *
+   * @return the number of elements extracted
+   */
+  template <class OutIt>
+  size_type drain(OutIt out) {
+    auto drained = swap_out();
+    std::move(drained.begin(), drained.end(), out);
+    return drained.size();
+  }
+
+  /** takes the whole underlying container in O(1), leaving this empty */
+  container_type swap_out() {
+    container_type out;
+    locked([&]() {
+      using std::swap;
+      swap(c_, out);
+    });
+    return out;
+  }
+
+  // Blocking remove -----------------------------------------------------------
+
+  /** blocks until an element is available */
+  value_type wait_extract_back() {
+    wait_lock_type_t lock{mutex_};
+    wait_not_empty(lock);
+    return take_back();
+  }
+
+  /** blocks until an element is available */
+  value_type wait_extract_front() {
+    wait_lock_type_t lock{mutex_};
+    wait_not_empty(lock);
+    return take_front();
+  }
+
+  /** blocks until an element is available, or @p timeout expires */
+  template <class Rep, class Period>
+  std::optional<value_type> wait_extract_back_for(
+      const std::chrono::duration<Rep, Period>& timeout) {
+    return wait_extract_back_until(std::chrono::steady_clock::now() + timeout);
+  }
+
+  /** blocks until an element is available, or @p timeout expires */
+  template <class Rep, class Period>
+  std::optional<value_type> wait_extract_front_for(
+      const std::chrono::duration<Rep, Period>& timeout) {
+    return wait_extract_front_until(std::chrono::steady_clock::now() + timeout);
+  }
+
+  /** blocks until an element is available, or @p deadline passes */
+  template <class Clock, class Duration>
+  std::optional<value_type> wait_extract_back_until(
+      const std::chrono::time_point<Clock, Duration>& deadline) {
+    wait_lock_type_t lock{mutex_};
+    if (!wait_not_empty_until(lock, deadline)) {
       return std::nullopt;
     }
-    auto v = std::move(c_.back());
-    c_.pop_back();
-    return std::move(v);
+    return take_back();
   }
 
-  std::optional<value_type> extract_front() {
-    lock_type_t lock{mutex_};
-    if (c_.empty()) {
+  /** blocks until an element is available, or @p deadline passes */
+  template <class Clock, class Duration>
+  std::optional<value_type> wait_extract_front_until(
+      const std::chrono::time_point<Clock, Duration>& deadline) {
+    wait_lock_type_t lock{mutex_};
+    if (!wait_not_empty_until(lock, deadline)) {
       return std::nullopt;
     }
-    auto v = std::move(c_.front());
-    c_.pop_front();
-    return std::move(v);
+    return take_front();
   }
 
   // arbitrary function --------------------------------------------------------
@@ -200,10 +418,14 @@ class container_base {
     return std::invoke(std::forward<F>(f), c_);
   }
 
+  /** wakes all waiters afterwards, in case @p f added elements */
   template <class F, class = if_invocable<F, container_type&>>
   auto apply(F&& f) {
-    lock_type_t lock{mutex_};
-    return std::invoke(std::forward<F>(f), c_);
+    notifier notify{*this, true};
+    return locked([&]() {
+      notify.arm();
+      return std::invoke(std::forward<F>(f), c_);
+    });
   }
 
   template <class F, class = if_invocable<F, const value_type&>>
@@ -217,10 +439,144 @@ class container_base {
   template <class F, class = If<std::is_invocable_v<F, value_type&> &&
                                 not std::is_invocable_v<F, const value_type&>>>
   void apply_each(F&& f) {
-    lock_type_t lock{mutex_};
-    for (auto& ii : c_) {
-      std::invoke(std::forward<F>(f), ii);
+    locked([&]() {
+      for (auto& ii : c_) {
+        std::invoke(std::forward<F>(f), ii);
+      }
+    });
+  }
+
+#ifdef NIL_ASYNC_COROUTINES
+  // From a coroutine ----------------------------------------------------------
+
+  /**
+   * Like apply, but co_awaiting it suspends the coroutine until the lock is
+   * free instead of blocking the thread. Needs an async_mutex. @p f is moved
+   * into the task, which must not outlive this
+   */
+  template <class F>
+  task<std::decay_t<std::invoke_result_t<F&, const container_type&>>>
+  apply_async(F f) const {
+    co_await mutex_.lock_async();
+    lock_type_t lock{mutex_, std::adopt_lock};
+    co_return std::invoke(f, c_);
+  }
+
+  template <class F>
+  task<std::decay_t<std::invoke_result_t<F&, container_type&>>> apply_async(
+      F f) {
+    notifier notify{*this, true};
+    co_await mutex_.lock_async();
+    lock_type_t lock{mutex_, std::adopt_lock};
+    notify.arm();
+    co_return std::invoke(f, c_);
+  }
+
+  /** suspends the coroutine until an element is available */
+  task<value_type> wait_extract_back_async() {
+    for (;;) {
+      co_await mutex_.lock_async();
+      wait_lock_type_t lock{mutex_, std::adopt_lock};
+      if (!c_.empty()) {
+        co_return take_back();
+      }
+      lock.release();
+      co_await async_waiters_.wait(mutex_);
+    }
+  }
+
+  /** suspends the coroutine until an element is available */
+  task<value_type> wait_extract_front_async() {
+    for (;;) {
+      co_await mutex_.lock_async();
+      wait_lock_type_t lock{mutex_, std::adopt_lock};
+      if (!c_.empty()) {
+        co_return take_front();
+      }
+      lock.release();
+      co_await async_waiters_.wait(mutex_);
+    }
+  }
+#endif
+
+  // Without waiting for the lock ----------------------------------------------
+
+  /** like push_back, but returns false if the mutex is taken */
+  template <class V = value_type>
+  bool try_push_back(V&& v) {
+    notifier notify{*this};
+    try_lock_type_t lock{mutex_, std::try_to_lock};
+    if (!lock) {
+      return false;
+    }
+    c_.push_back(std::forward<V>(v));
+    notify.arm();
+    return true;
+  }
+
+  /** like push_front, but returns false if the mutex is taken */
+  template <class V = value_type>
+  bool try_push_front(V&& v) {
+    notifier notify{*this};
+    try_lock_type_t lock{mutex_, std::try_to_lock};
+    if (!lock) {
+      return false;
+    }
+    c_.push_front(std::forward<V>(v));
+    notify.arm();
+    return true;
+  }
+
+  /** like extract_back, but also returns nullopt if the mutex is taken */
+  std::optional<value_type> try_extract_back() {
+    try_lock_type_t lock{mutex_, std::try_to_lock};
+    if (!lock || c_.empty()) {
+      return std::nullopt;
     }
+    return take_back();
+  }
+
+  /** like extract_front, but also returns nullopt if the mutex is taken */
+  std::optional<value_type> try_extract_front() {
+    try_lock_type_t lock{mutex_, std::try_to_lock};
+    if (!lock || c_.empty()) {
+      return std::nullopt;
+    }
+    return take_front();
+  }
+
+  /**
+   * Like apply, but doesn't wait if the mutex is taken. Returns whether @p f
+   * ran if it returns void, otherwise its result or nullopt
+   */
+  template <class F, class = if_invocable<F, const container_type&>>
+  auto try_apply(F&& f) const {
+    try_lock_type_t lock{mutex_, std::try_to_lock};
+    return detail::invoke_if_owned(lock, std::forward<F>(f), c_);
+  }
+
+  template <class F, class = if_invocable<F, container_type&>>
+  auto try_apply(F&& f) {
+    notifier notify{*this, true};
+    try_lock_type_t lock{mutex_, std::try_to_lock};
+    return apply_if_owned(lock, notify, std::forward<F>(f));
+  }
+
+  /** like try_apply, but waits up to @p timeout for the mutex */
+  template <class F, class Rep, class Period,
+            class = if_invocable<F, const container_type&>>
+  auto try_apply_for(F&& f,
+                     const std::chrono::duration<Rep, Period>& timeout) const {
+    try_lock_type_t lock{mutex_, timeout};
+    return detail::invoke_if_owned(lock, std::forward<F>(f), c_);
+  }
+
+  template <class F, class Rep, class Period,
+            class = if_invocable<F, container_type&>>
+  auto try_apply_for(F&& f, const std::chrono::duration<Rep, Period>& timeout) {
+    notifier notify{*this, true};
+    try_lock_type_t lock{mutex_, timeout};
+    return apply_if_owned(lock, notify, std::forward<F>(f));
   }
 
   // state observers -----------------------------------------------------------
@@ -235,9 +591,121 @@ class container_base {
     return c_.empty();
   }
 
+  // instrumentation -----------------------------------------------------------
+
+  /**
+   * Names this instance in the lock_registry. Only compiles if the mutex
+   * supports it, like instrumented_mutex
+   */
+  void set_lock_name(const std::string& name) { mutex_.set_name(name); }
+
  private:
-  mutable mutex_type mutex_;
-  container_type c_;
+  friend struct detail::lock_access;  //!< for apply_all
+
+  /**
+   * Notifies waiters on destruction if arm() saw any. Declared before the lock
+   * so waiters are woken after the lock is released.
+   */
+  class notifier {
+   public:
+    explicit notifier(container_base& c, bool all = false) : c_{c}, all_{all} {}
+    ~notifier() {
+      if (!armed_) {
+        return;
+      }
+      if (all_) {
+        c_.cv_.notify_all();
+      } else {
+        c_.cv_.notify_one();
+      }
+    }
+
+    /** must be called with the lock held */
+    void arm() {
+      armed_ = c_.waiters_ > 0;
+#ifdef NIL_ASYNC_COROUTINES
+      resume_ = c_.async_waiters_.take(all_);
+#endif
+    }
+
+   private:
+    container_base& c_;
+    bool all_;
+    bool armed_{false};
+#ifdef NIL_ASYNC_COROUTINES
+    async_waiters::batch resume_;  //!< resumed after the lock is released
+#endif
+  };
+
+  /**
+   * Runs @p f with the lock held. A combining mutex, like flat_combining_mutex,
+   * may run it on whichever thread holds the lock instead
+   */
+  template <class F>
+  auto locked(F&& f) {
+    if constexpr (is_combining_v<mutex_type>) {
+      return mutex_.combine(std::forward<F>(f));
+    } else {
+      lock_type_t lock{mutex_};
+      return std::invoke(std::forward<F>(f));
+    }
+  }
+
+  // must be called with the lock held -----------------------------------------
+
+  value_type take_back() {
+    auto v = std::move(c_.back());
+    c_.pop_back();
+    return v;
+  }
+
+  value_type take_front() {
+    auto v = std::move(c_.front());
+    c_.pop_front();
+    return v;
+  }
+
+  template <class F>
+  auto apply_if_owned(const try_lock_type_t& lock, notifier& notify, F&& f) {
+    if (lock) {
+      notify.arm();
+    }
+    return detail::invoke_if_owned(lock, std::forward<F>(f), c_);
+  }
+
+  void wait_not_empty(wait_lock_type_t& lock) {
+    waiters_++;
+    cv_.wait(lock, [this]() { return !c_.empty(); });
+    waiters_--;
+  }
+
+  template <class Clock, class Duration>
+  bool wait_not_empty_until(
+      wait_lock_type_t& lock,
+      const std::chrono::time_point<Clock, Duration>& deadline) {
+    waiters_++;
+    const auto ready =
+        cv_.wait_until(lock, deadline, [this]() { return !c_.empty(); });
+    waiters_--;
+    return ready;
+  }
+
+  alignas(Layout::mutex_alignment) alignas(Mutex) mutable mutex_type mutex_;
+  alignas(Layout::data_alignment) alignas(C) container_type c_;
+  cv_type cv_;
+  std::size_t waiters_{0};  //!< guarded by mutex_
+
+#ifdef NIL_ASYNC_COROUTINES
+  /** takes up no space unless the mutex is an async_mutex */
+  struct no_async_waiters {
+    async_waiters::batch take(bool) noexcept { return {}; }
+  };
+
+  /** coroutines in wait_extract_*_async, guarded by mutex_ */
+  [[no_unique_address]] std::conditional_t<std::is_same_v<Mutex, async_mutex>,
+                                           async_waiters, no_async_waiters>
+      async_waiters_;
+#endif
 };
 
 }  // namespace nil::async
@@ -54,6 +54,20 @@ using erase_func = decltype(std::declval<T>().erase(std::declval<I>()));
 template <class T>
 using clear_func = decltype(std::declval<T>().clear());
 
+template <class T, class I = typename T::const_iterator>
+using splice_func = decltype(std::declval<T>().splice(std::declval<I>(),
+                                                      std::declval<T&>()));
+
+template <class T, class K>
+using find_func = decltype(std::declval<const T>().find(std::declval<K>()));
+
+template <class T, class K, class V>
+using insert_or_assign_func = decltype(std::declval<T>().insert_or_assign(
+    std::declval<K>(), std::declval<V>()));
+
+template <class T, class K>
+using erase_key_func = decltype(std::declval<T>().erase(std::declval<K>()));
+
 template <class T>
 using size_func = decltype(std::declval<const T>().size());
 
@@ -135,6 +149,34 @@ template <class T,                           //
           class I = typename T::iterator>
 inline constexpr auto is_list_like_v = is_list_like<T, V, S, I>::value;
 
+template <class T,                            //
+          class K = typename T::key_type,     //
+          class M = typename T::mapped_type,  //
+          class S = typename T::size_type>
+using is_map_like = std::conjunction<          //
+    exists<find_func, T, K>,                   //
+    exists<insert_or_assign_func, T, K, M>,    //
+    is_exact<S, erase_key_func, T, K>,         //
+    is_exact<S, size_func, T>,                 //
+    is_exact<bool, empty_func, T>,             //
+    exists<clear_func, T>>;
+
+template <class T,                            //
+          class K = typename T::key_type,     //
+          class M = typename T::mapped_type,  //
+          class S = typename T::size_type>
+inline constexpr auto is_map_like_v = is_map_like<T, K, M, S>::value;
+
+// -----------------------------------------------------------------------------
+
+/** mutexes that can run a critical section for us, like flat_combining_mutex */
+template <class M>
+using combine_func =
+    decltype(std::declval<M&>().combine(std::declval<void (&)()>()));
+
+template <class M>
+inline constexpr auto is_combining_v = exists_v<combine_func, M>;
+
 }  // namespace nil::async
 
 #endif  // NIL_SRC_ASYNC_INC_ASYNC_CONTAINERTRAITS_HPP_
@@ -0,0 +1,147 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_DISTRIBUTEDSHAREDMUTEX_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_DISTRIBUTEDSHAREDMUTEX_HPP_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "async/adaptive_mutex.hpp"
+#include "async/cache_line.hpp"
+
+namespace nil::async {
+
+/**
+ * A reader-writer mutex where readers don't share a counter (a "big-reader"
+ * lock). Each thread is assigned one of a number of reader slots, each on its
+ * own cache line, so concurrent readers on different cores don't bounce a
+ * cache line between them the way they do with std::shared_mutex.
+ *
+ * The price is paid by writers: taking the lock exclusively has to wait for
+ * every reader slot to drain. So this is for read-mostly data with many
+ * reader threads.
+ *
+ * A reader that finds a writer active parks on the writer's mutex until it's
+ * done, rather than spinning. Writers wait for readers to leave by spinning,
+ * then yielding.
+ *
+ * Meets the SharedMutex requirements (without the timed functions), so it can
+ * be used as the SharedMutex parameter of atomic_rw_base.
+ *
+ * @note like std::shared_mutex, unlock_shared must be called by the thread
+ * that called lock_shared, so don't hand read proxies to other threads
+ */
+class distributed_shared_mutex {
+  struct alignas(cache_line_size) slot {
+    std::atomic<long> readers{0};
+  };
+
+ public:
+  /** one slot per hardware thread, rounded up to a power of two */
+  distributed_shared_mutex()
+      : mask_{round_up(std::thread::hardware_concurrency()) - 1},
+        slots_{std::make_unique<slot[]>(mask_ + 1)} {}
+
+  distributed_shared_mutex(const distributed_shared_mutex&) = delete;
+  distributed_shared_mutex& operator=(const distributed_shared_mutex&) =
+      delete;
+
+  // exclusive -----------------------------------------------------------------
+
+  void lock() {
+    writer_mutex_.lock();
+    writer_.store(true, std::memory_order_seq_cst);
+    for (std::size_t ii{0}; ii <= mask_; ii++) {
+      wait_for_readers(slots_[ii]);
+    }
+  }
+
+  bool try_lock() {
+    if (!writer_mutex_.try_lock()) {
+      return false;
+    }
+    writer_.store(true, std::memory_order_seq_cst);
+    for (std::size_t ii{0}; ii <= mask_; ii++) {
+      if (slots_[ii].readers.load(std::memory_order_seq_cst) != 0) {
+        unlock();
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void unlock() {
+    writer_.store(false, std::memory_order_release);
+    writer_mutex_.unlock();
+  }
+
+  // shared --------------------------------------------------------------------
+
+  void lock_shared() {
+    auto& s = local_slot();
+    while (!enter(s)) {
+      // park until the writer is done, then try again
+      std::lock_guard<adaptive_mutex> wait{writer_mutex_};
+    }
+  }
+
+  bool try_lock_shared() { return enter(local_slot()); }
+
+  void unlock_shared() {
+    local_slot().readers.fetch_sub(1, std::memory_order_release);
+  }
+
+  // state observers -----------------------------------------------------------
+
+  std::size_t slot_count() const noexcept { return mask_ + 1; }
+
+ private:
+  static std::size_t round_up(std::size_t n) {
+    std::size_t pow2 = 1;
+    while (pow2 < n) {
+      pow2 <<= 1;
+    }
+    return pow2;
+  }
+
+  /** threads are handed out slots round robin, the first time they read */
+  slot& local_slot() const noexcept {
+    static std::atomic<std::size_t> next{0};
+    thread_local const std::size_t index =
+        next.fetch_add(1, std::memory_order_relaxed);
+    return slots_[index & mask_];
+  }
+
+  /**
+   * Announces a reader in @p s, then backs out if a writer is active. The
+   * seq_cst pairs with lock(), which sets writer_ before checking the slots
+   */
+  bool enter(slot& s) noexcept {
+    s.readers.fetch_add(1, std::memory_order_seq_cst);
+    if (!writer_.load(std::memory_order_seq_cst)) {
+      return true;
+    }
+    s.readers.fetch_sub(1, std::memory_order_release);
+    return false;
+  }
+
+  static void wait_for_readers(const slot& s) noexcept {
+    for (int spins{0}; s.readers.load(std::memory_order_seq_cst) != 0;
+         spins++) {
+      if (spins < 64) {
+        cpu_relax();
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  const std::size_t mask_;
+  const std::unique_ptr<slot[]> slots_;
+  alignas(cache_line_size) std::atomic<bool> writer_{false};
+  adaptive_mutex writer_mutex_;  //!< serializes writers, parks readers
+};
+
+}  // namespace nil::async
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_DISTRIBUTEDSHAREDMUTEX_HPP_
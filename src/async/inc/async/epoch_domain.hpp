@@ -0,0 +1,178 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_EPOCHDOMAIN_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_EPOCHDOMAIN_HPP_
+
+#include <memory>
+
+#include "async/reclaim_base.hpp"
+
+namespace nil::async {
+
+/**
+ * Epoch-based memory reclamation for lock-free structures.
+ *
+ * Readers pin the domain (cheap, one store and a fence) for as long as they
+ * hold raw pointers into a shared structure. Writers unlink a node and retire
+ * it, and it is freed once every thread that could have seen it has unpinned.
+ *
+ * Retired nodes are kept in a per-thread list. Every `collect_threshold`
+ * retires the thread tries to advance the global epoch and frees whatever is
+ * at least two epochs old. This keeps garbage bounded as long as pinned
+ * threads make progress; a thread that stays pinned forever stalls
+ * reclamation for everyone. Use hazard_domain if that's a concern.
+ *
+ * @code
+ *   auto guard = domain.pin();
+ *   node* n = guard.protect(head_);
+ *   ...
+ *   if (head_.compare_exchange_strong(n, n->next)) {
+ *     domain.retire(n);
+ *   }
+ * @endcode
+ *
+ * @note the domain may be destroyed while other threads still hold records in
+ * it, as long as none of them are still pinned or retiring into it
+ */
+class epoch_domain {
+  struct record {
+    std::atomic<std::uint64_t> epoch{0};  //!< 0 if not pinned, else 2e + 1
+    std::atomic<bool> in_use{false};
+    record* next{nullptr};
+    std::size_t depth{0};  //!< owner only, for nested pins
+    std::size_t retires_since_collect{0};  //!< owner only
+    std::vector<retired_ptr> garbage;      //!< owner only
+  };
+
+  struct state {
+    using record_type = record;
+    std::atomic<std::uint64_t> epoch{1};
+    record_registry<record> records;
+  };
+
+ public:
+  static constexpr std::size_t collect_threshold = 64;
+
+  /**
+   * RAII pin. While any guard is alive on a thread, nothing that thread can
+   * reach through protect() will be freed. Guards may be nested.
+   */
+  class guard {
+   public:
+    explicit guard(epoch_domain& domain)
+        : rec_{&local_record(domain.state_)} {
+      if (rec_->depth++ == 0) {
+        const auto e = domain.state_->epoch.load(std::memory_order_relaxed);
+        rec_->epoch.store(2 * e + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+      }
+    }
+
+    guard(const guard&) = delete;
+    guard& operator=(const guard&) = delete;
+    guard(guard&& other) noexcept : rec_{std::exchange(other.rec_, nullptr)} {}
+    guard& operator=(guard&&) = delete;
+
+    ~guard() {
+      if (rec_ && --rec_->depth == 0) {
+        rec_->epoch.store(0, std::memory_order_release);
+      }
+    }
+
+    /** loads @p src, the result is safe to dereference while pinned */
+    template <class T>
+    T* protect(const std::atomic<T*>& src) const {
+      return src.load(std::memory_order_acquire);
+    }
+
+   private:
+    record* rec_;
+  };
+
+  // constructors --------------------------------------------------------------
+
+  epoch_domain() : state_{std::make_shared<state>()} {}
+
+  /** frees all remaining garbage, no thread may be using the domain */
+  ~epoch_domain() { state_->records.reclaim_all(); }
+
+  epoch_domain(const epoch_domain&) = delete;
+  epoch_domain& operator=(const epoch_domain&) = delete;
+  epoch_domain(epoch_domain&&) = delete;
+  epoch_domain& operator=(epoch_domain&&) = delete;
+
+  /** process-wide default domain */
+  static epoch_domain& global() {
+    static epoch_domain domain;
+    return domain;
+  }
+
+  // protect -------------------------------------------------------------------
+
+  guard pin() { return guard{*this}; }
+
+  // retire --------------------------------------------------------------------
+
+  /**
+   * Hands @p p to the domain to be freed with @tparam D once no pinned thread
+   * can still reach it. @p p must already be unlinked from the structure.
+   *
+   * @tparam D - a stateless deleter
+   */
+  template <class T, class D = std::default_delete<T>>
+  void retire(T* p) {
+    auto& rec = local_record(state_);
+    const auto e = state_->epoch.load(std::memory_order_acquire);
+    rec.garbage.push_back({p, &erased_delete<T, D>, e});
+    if (++rec.retires_since_collect >= collect_threshold) {
+      collect();
+    }
+  }
+
+  /** tries to advance the epoch, then frees this thread's expired garbage */
+  void collect() {
+    auto& rec = local_record(state_);
+    rec.retires_since_collect = 0;
+    state_->records.adopt_orphans(rec.garbage);
+
+    // two steps is enough to expire everything retired before this call
+    for (int ii{0}; ii < 2 && try_advance(); ii++) {
+    }
+
+    const auto e = state_->epoch.load(std::memory_order_acquire);
+    auto expired = std::partition(
+        rec.garbage.begin(), rec.garbage.end(),
+        [e](const retired_ptr& r) { return r.epoch + 2 > e; });
+    std::for_each(expired, rec.garbage.end(),
+                  [](const retired_ptr& r) { r.reclaim(); });
+    rec.garbage.erase(expired, rec.garbage.end());
+  }
+
+  /** number of nodes this thread has retired that are not yet freed */
+  std::size_t pending() { return local_record(state_).garbage.size(); }
+
+ private:
+  /** advances the global epoch if every pinned thread has observed it */
+  bool try_advance() {
+    auto e = state_->epoch.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    bool all_caught_up = true;
+    state_->records.for_each([&](const record& r) {
+      const auto local = r.epoch.load(std::memory_order_relaxed);
+      if (local != 0 && local != 2 * e + 1) {
+        all_caught_up = false;
+      }
+    });
+    if (!all_caught_up) {
+      return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return state_->epoch.compare_exchange_strong(e, e + 1,
+                                                 std::memory_order_acq_rel);
+  }
+
+  std::shared_ptr<state> state_;
+};
+
+}  // namespace nil::async
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_EPOCHDOMAIN_HPP_
@@ -0,0 +1,190 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_FLATCOMBININGMUTEX_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_FLATCOMBININGMUTEX_HPP_
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+
+#include "async/adaptive_mutex.hpp"
+#include "async/cache_line.hpp"
+
+namespace nil::async {
+
+/**
+ * A mutex that can also run critical sections on behalf of other threads
+ * (flat combining). Instead of every thread taking the lock in turn, a thread
+ * calling combine() publishes its operation in a slot, and whichever thread
+ * gets the lock runs every published operation in one pass. The protected
+ * data stays in that one core's cache, and the lock changes hands far less
+ * often under heavy contention.
+ *
+ * Threads are assigned one of a number of slots, each on its own cache line,
+ * the same way as distributed_shared_mutex. If two threads share a slot and
+ * both publish at once, the second just takes the lock itself.
+ *
+ * Meets the Lockable requirements, so lock() and unlock() work as usual and
+ * anything that can't be combined (readers, condition variables, apply_all)
+ * simply takes the lock. container_base hands its mutations to combine().
+ *
+ * @note operations run on whichever thread holds the lock, so they mustn't
+ * depend on thread_local state or the thread's identity. Exceptions are
+ * passed back to the thread that published the operation
+ */
+class flat_combining_mutex {
+  /** an operation published by a thread, completed by the combiner */
+  struct request {
+    explicit request(void (*run)(request&)) noexcept : run{run} {}
+
+    void (*const run)(request&);
+    std::atomic<bool> done{false};
+    std::exception_ptr error;
+  };
+
+  /** @p f and storage for its result */
+  template <class F, class R = std::invoke_result_t<F&>>
+  struct task : request {
+    static_assert(!std::is_reference_v<R>, "combine can't return references");
+
+    explicit task(F& f) noexcept : request{&execute}, f{f} {}
+
+    static void execute(request& r) {
+      auto& self = static_cast<task&>(r);
+      if constexpr (std::is_void_v<R>) {
+        std::invoke(self.f);
+      } else {
+        self.result.emplace(std::invoke(self.f));
+      }
+    }
+
+    R get() {
+      if constexpr (!std::is_void_v<R>) {
+        return std::move(*result);
+      }
+    }
+
+    F& f;
+    std::optional<std::conditional_t<std::is_void_v<R>, char, R>> result;
+  };
+
+  struct alignas(cache_line_size) slot {
+    std::atomic<request*> pending{nullptr};
+  };
+
+ public:
+  /** attempts on the lock before parking on it */
+  static constexpr int spin_limit = 64;
+
+  /** one slot per hardware thread, rounded up to a power of two */
+  flat_combining_mutex()
+      : mask_{round_up(std::thread::hardware_concurrency()) - 1},
+        slots_{std::make_unique<slot[]>(mask_ + 1)} {}
+
+  flat_combining_mutex(const flat_combining_mutex&) = delete;
+  flat_combining_mutex& operator=(const flat_combining_mutex&) = delete;
+
+  // Lockable ------------------------------------------------------------------
+
+  void lock() noexcept { mutex_.lock(); }
+  bool try_lock() noexcept { return mutex_.try_lock(); }
+  void unlock() noexcept { mutex_.unlock(); }
+
+  // combining -----------------------------------------------------------------
+
+  /**
+   * Runs @p f with the lock held, either on this thread or on whichever
+   * thread holds the lock, and returns its result. @p f's result must be
+   * movable, and is moved once more than it would be by calling it directly
+   */
+  template <class F>
+  std::invoke_result_t<F&> combine(F&& f) {
+    task<std::remove_reference_t<F>> t{f};
+    auto& s = local_slot();
+    request* expected = nullptr;
+    if (!s.pending.compare_exchange_strong(expected, &t,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed)) {
+      // a thread sharing our slot is waiting on the combiner already
+      std::lock_guard<adaptive_mutex> lock{mutex_};
+      return std::invoke(f);
+    }
+    wait_or_combine(t);
+    if (t.error) {
+      std::rethrow_exception(t.error);
+    }
+    return t.get();
+  }
+
+  // state observers -----------------------------------------------------------
+
+  std::size_t slot_count() const noexcept { return mask_ + 1; }
+
+ private:
+  static std::size_t round_up(std::size_t n) {
+    std::size_t pow2 = 1;
+    while (pow2 < n) {
+      pow2 <<= 1;
+    }
+    return pow2;
+  }
+
+  /** threads are handed out slots round robin, the first time they combine */
+  slot& local_slot() const noexcept {
+    static std::atomic<std::size_t> next{0};
+    thread_local const std::size_t index =
+        next.fetch_add(1, std::memory_order_relaxed);
+    return slots_[index & mask_];
+  }
+
+  /**
+   * Waits for a combiner to complete @p r, or becomes the combiner itself.
+   * Spins for a while, then parks on the lock rather than burning the CPU
+   */
+  void wait_or_combine(const request& r) noexcept {
+    for (int spins{0};; spins++) {
+      if (r.done.load(std::memory_order_acquire)) {
+        return;
+      }
+      if (mutex_.try_lock()) {
+        break;
+      }
+      if (spins >= spin_limit) {
+        mutex_.lock();
+        break;
+      }
+      cpu_relax();
+    }
+    combine_pending();  // runs ours too, if nobody got to it first
+    mutex_.unlock();
+  }
+
+  /** runs every published request, must be called with the lock held */
+  void combine_pending() noexcept {
+    for (std::size_t ii{0}; ii <= mask_; ii++) {
+      auto* r = slots_[ii].pending.load(std::memory_order_acquire);
+      if (!r) {
+        continue;
+      }
+      try {
+        r->run(*r);
+      } catch (...) {
+        r->error = std::current_exception();
+      }
+      // the owner may publish again as soon as it sees done
+      slots_[ii].pending.store(nullptr, std::memory_order_relaxed);
+      r->done.store(true, std::memory_order_release);
+    }
+  }
+
+  const std::size_t mask_;
+  const std::unique_ptr<slot[]> slots_;
+  alignas(cache_line_size) adaptive_mutex mutex_;
+};
+
+}  // namespace nil::async
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_FLATCOMBININGMUTEX_HPP_
@@ -0,0 +1,184 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_HAZARDDOMAIN_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_HAZARDDOMAIN_HPP_
+
+#include <array>
+#include <memory>
+#include <stdexcept>
+
+#include "async/reclaim_base.hpp"
+
+namespace nil::async {
+
+/**
+ * Hazard pointer memory reclamation for lock-free structures. Same surface as
+ * epoch_domain, but each guard protects exactly one pointer.
+ *
+ * This costs readers a fence per protected pointer, but unlike epoch_domain a
+ * stalled reader can only hold back the nodes it has actually protected, so
+ * the garbage per thread is strictly bounded (by `collect_threshold` plus the
+ * total number of hazard slots).
+ *
+ * @code
+ *   auto guard = domain.pin();
+ *   node* n = guard.protect(head_);
+ *   ...
+ *   if (head_.compare_exchange_strong(n, n->next)) {
+ *     domain.retire(n);
+ *   }
+ * @endcode
+ *
+ * @note the domain may be destroyed while other threads still hold records in
+ * it, as long as none of them still hold a guard or are retiring into it
+ */
+class hazard_domain {
+ public:
+  static constexpr std::size_t slots_per_thread = 8;
+  static constexpr std::size_t collect_threshold = 64;
+
+ private:
+  struct record {
+    std::array<std::atomic<void*>, slots_per_thread> slots{};
+    std::atomic<bool> in_use{false};
+    record* next{nullptr};
+    std::array<bool, slots_per_thread> taken{};  //!< owner only
+    std::vector<retired_ptr> garbage;            //!< owner only
+  };
+
+  struct state {
+    using record_type = record;
+    record_registry<record> records;
+  };
+
+ public:
+  /**
+   * RAII ownership of one hazard slot. Whatever protect() last returned is not
+   * freed until the guard is reset, re-used or destroyed.
+   *
+   * @throws std::length_error if the thread already holds `slots_per_thread`
+   * guards for this domain
+   */
+  class guard {
+   public:
+    explicit guard(hazard_domain& domain) {
+      auto& rec = local_record(domain.state_);
+      for (std::size_t ii{0}; ii < slots_per_thread; ii++) {
+        if (!rec.taken[ii]) {
+          rec.taken[ii] = true;
+          taken_ = &rec.taken[ii];
+          slot_ = &rec.slots[ii];
+          return;
+        }
+      }
+      throw std::length_error("nil::async::hazard_domain: out of slots");
+    }
+
+    guard(const guard&) = delete;
+    guard& operator=(const guard&) = delete;
+    guard(guard&& other) noexcept
+        : slot_{std::exchange(other.slot_, nullptr)},
+          taken_{std::exchange(other.taken_, nullptr)} {}
+    guard& operator=(guard&&) = delete;
+
+    ~guard() {
+      if (slot_) {
+        slot_->store(nullptr, std::memory_order_release);
+        *taken_ = false;
+      }
+    }
+
+    /** loads @p src and protects the result until the next protect/reset */
+    template <class T>
+    T* protect(const std::atomic<T*>& src) {
+      auto* p = src.load(std::memory_order_relaxed);
+      while (true) {
+        slot_->store(p, std::memory_order_seq_cst);
+        auto* again = src.load(std::memory_order_seq_cst);
+        if (again == p) {
+          return p;
+        }
+        p = again;
+      }
+    }
+
+    /** stops protecting the current pointer, without giving up the slot */
+    void reset() { slot_->store(nullptr, std::memory_order_release); }
+
+   private:
+    std::atomic<void*>* slot_;
+    bool* taken_;
+  };
+
+  // constructors --------------------------------------------------------------
+
+  hazard_domain() : state_{std::make_shared<state>()} {}
+
+  /** frees all remaining garbage, no thread may be using the domain */
+  ~hazard_domain() { state_->records.reclaim_all(); }
+
+  hazard_domain(const hazard_domain&) = delete;
+  hazard_domain& operator=(const hazard_domain&) = delete;
+  hazard_domain(hazard_domain&&) = delete;
+  hazard_domain& operator=(hazard_domain&&) = delete;
+
+  /** process-wide default domain */
+  static hazard_domain& global() {
+    static hazard_domain domain;
+    return domain;
+  }
+
+  // protect -------------------------------------------------------------------
+
+  guard pin() { return guard{*this}; }
+
+  // retire --------------------------------------------------------------------
+
+  /**
+   * Hands @p p to the domain to be freed with @tparam D once no guard protects
+   * it. @p p must already be unlinked from the structure.
+   *
+   * @tparam D - a stateless deleter
+   */
+  template <class T, class D = std::default_delete<T>>
+  void retire(T* p) {
+    auto& rec = local_record(state_);
+    rec.garbage.push_back({p, &erased_delete<T, D>, 0});
+    if (rec.garbage.size() >= collect_threshold) {
+      collect();
+    }
+  }
+
+  /** frees every node retired by this thread that no guard protects */
+  void collect() {
+    auto& rec = local_record(state_);
+    state_->records.adopt_orphans(rec.garbage);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::vector<void*> hazards;
+    state_->records.for_each([&hazards](const record& r) {
+      for (const auto& slot : r.slots) {
+        if (auto* p = slot.load(std::memory_order_acquire)) {
+          hazards.push_back(p);
+        }
+      }
+    });
+    std::sort(hazards.begin(), hazards.end());
+
+    auto expired = std::partition(
+        rec.garbage.begin(), rec.garbage.end(), [&hazards](const auto& r) {
+          return std::binary_search(hazards.cbegin(), hazards.cend(), r.p);
+        });
+    std::for_each(expired, rec.garbage.end(),
+                  [](const retired_ptr& r) { r.reclaim(); });
+    rec.garbage.erase(expired, rec.garbage.end());
+  }
+
+  /** number of nodes this thread has retired that are not yet freed */
+  std::size_t pending() { return local_record(state_).garbage.size(); }
+
+ private:
+  std::shared_ptr<state> state_;
+};
+
+}  // namespace nil::async
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_HAZARDDOMAIN_HPP_
@@ -0,0 +1,242 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_INSTRUMENTEDMUTEX_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_INSTRUMENTEDMUTEX_HPP_
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "async/lock_stats.hpp"
+
+namespace nil::async {
+
+#ifdef NIL_ASYNC_LOCK_STATS
+
+/**
+ * Wraps any mutex and records every acquisition in the lock_registry, under
+ * the name given to set_name (or "unnamed"). Use it as the Mutex parameter of
+ * any _base class, and name the instance through its set_lock_name function:
+ *
+ * @code
+ *   nil::atomic_base<T, instrumented_mutex<std::mutex>, std::lock_guard> a;
+ *   a.set_lock_name("orders");
+ *   ...
+ *   lock_registry::global().dump_text(std::cout);
+ * @endcode
+ *
+ * Records acquisitions, how many of them had to wait, and histograms of the
+ * wait time (contended acquisitions only) and hold time (exclusive locks
+ * only). Shared and timed locks are forwarded too, if @tparam Mutex has them.
+ * A timed lock that gives up isn't recorded.
+ *
+ * @note only records anything if NIL_ASYNC_LOCK_STATS is defined. Otherwise
+ * this is a plain wrapper that forwards to @tparam Mutex, and set_name does
+ * nothing
+ *
+ * @tparam Mutex - the mutex to wrap, like std::mutex or std::shared_mutex
+ */
+template <class Mutex>
+class instrumented_mutex {
+  using clock = std::chrono::steady_clock;
+
+ public:
+  using mutex_type = Mutex;
+
+  instrumented_mutex()
+      : stats_{lock_registry::global().stats_for(lock_registry::unnamed)} {}
+
+  instrumented_mutex(const instrumented_mutex&) = delete;
+  instrumented_mutex& operator=(const instrumented_mutex&) = delete;
+
+  /** moves this lock's future stats to the entry for @p name */
+  void set_name(const std::string& name) {
+    auto stats = lock_registry::global().stats_for(name);
+    std::lock_guard<Mutex> lock{mutex_};
+    stats_ = std::move(stats);
+  }
+
+  // exclusive -----------------------------------------------------------------
+
+  void lock() {
+    if (mutex_.try_lock()) {
+      acquired();
+      return;
+    }
+    const auto start = clock::now();
+    mutex_.lock();
+    acquired_after(start);
+  }
+
+  bool try_lock() {
+    if (!mutex_.try_lock()) {
+      return false;
+    }
+    acquired();
+    return true;
+  }
+
+  template <class Rep, class Period, class M = Mutex>
+  auto try_lock_for(const std::chrono::duration<Rep, Period>& timeout)
+      -> decltype(std::declval<M&>().try_lock_for(timeout)) {
+    return try_lock_timed([&]() { return mutex_.try_lock_for(timeout); });
+  }
+
+  template <class Clock, class Duration, class M = Mutex>
+  auto try_lock_until(const std::chrono::time_point<Clock, Duration>& deadline)
+      -> decltype(std::declval<M&>().try_lock_until(deadline)) {
+    return try_lock_timed([&]() { return mutex_.try_lock_until(deadline); });
+  }
+
+  void unlock() {
+    stats_->hold.record(clock::now() - locked_at_);
+    mutex_.unlock();
+  }
+
+  // shared --------------------------------------------------------------------
+
+  void lock_shared() {
+    if (mutex_.try_lock_shared()) {
+      stats_->acquisitions.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    const auto start = clock::now();
+    mutex_.lock_shared();
+    record_wait(clock::now() - start);
+  }
+
+  bool try_lock_shared() {
+    if (!mutex_.try_lock_shared()) {
+      return false;
+    }
+    stats_->acquisitions.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  template <class Rep, class Period, class M = Mutex>
+  auto try_lock_shared_for(const std::chrono::duration<Rep, Period>& timeout)
+      -> decltype(std::declval<M&>().try_lock_shared_for(timeout)) {
+    return try_lock_shared_timed(
+        [&]() { return mutex_.try_lock_shared_for(timeout); });
+  }
+
+  template <class Clock, class Duration, class M = Mutex>
+  auto try_lock_shared_until(
+      const std::chrono::time_point<Clock, Duration>& deadline)
+      -> decltype(std::declval<M&>().try_lock_shared_until(deadline)) {
+    return try_lock_shared_timed(
+        [&]() { return mutex_.try_lock_shared_until(deadline); });
+  }
+
+  void unlock_shared() { mutex_.unlock_shared(); }
+
+ private:
+  /** like lock, but @p wait may give up */
+  template <class Wait>
+  bool try_lock_timed(Wait&& wait) {
+    if (mutex_.try_lock()) {
+      acquired();
+      return true;
+    }
+    const auto start = clock::now();
+    if (!wait()) {
+      return false;
+    }
+    acquired_after(start);
+    return true;
+  }
+
+  /** like lock_shared, but @p wait may give up */
+  template <class Wait>
+  bool try_lock_shared_timed(Wait&& wait) {
+    if (mutex_.try_lock_shared()) {
+      stats_->acquisitions.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+    const auto start = clock::now();
+    if (!wait()) {
+      return false;
+    }
+    record_wait(clock::now() - start);
+    return true;
+  }
+
+  // must be called with the lock held -----------------------------------------
+
+  void acquired() {
+    stats_->acquisitions.fetch_add(1, std::memory_order_relaxed);
+    locked_at_ = clock::now();
+  }
+
+  void acquired_after(clock::time_point start) {
+    locked_at_ = clock::now();
+    record_wait(locked_at_ - start);
+  }
+
+  void record_wait(clock::duration waited) {
+    stats_->acquisitions.fetch_add(1, std::memory_order_relaxed);
+    stats_->contended.fetch_add(1, std::memory_order_relaxed);
+    stats_->wait.record(waited);
+  }
+
+  Mutex mutex_;
+  std::shared_ptr<lock_stats> stats_;  //!< only swapped under mutex_
+  clock::time_point locked_at_;        //!< written by the exclusive owner
+};
+
+#else
+
+/** instrumentation disabled, forwards everything to @tparam Mutex */
+template <class Mutex>
+class instrumented_mutex {
+ public:
+  using mutex_type = Mutex;
+
+  instrumented_mutex() = default;
+  instrumented_mutex(const instrumented_mutex&) = delete;
+  instrumented_mutex& operator=(const instrumented_mutex&) = delete;
+
+  void set_name(const std::string&) {}
+
+  void lock() { mutex_.lock(); }
+  bool try_lock() { return mutex_.try_lock(); }
+  void unlock() { mutex_.unlock(); }
+
+  template <class Rep, class Period, class M = Mutex>
+  auto try_lock_for(const std::chrono::duration<Rep, Period>& timeout)
+      -> decltype(std::declval<M&>().try_lock_for(timeout)) {
+    return mutex_.try_lock_for(timeout);
+  }
+
+  template <class Clock, class Duration, class M = Mutex>
+  auto try_lock_until(const std::chrono::time_point<Clock, Duration>& deadline)
+      -> decltype(std::declval<M&>().try_lock_until(deadline)) {
+    return mutex_.try_lock_until(deadline);
+  }
+
+  void lock_shared() { mutex_.lock_shared(); }
+  bool try_lock_shared() { return mutex_.try_lock_shared(); }
+  void unlock_shared() { mutex_.unlock_shared(); }
+
+  template <class Rep, class Period, class M = Mutex>
+  auto try_lock_shared_for(const std::chrono::duration<Rep, Period>& timeout)
+      -> decltype(std::declval<M&>().try_lock_shared_for(timeout)) {
+    return mutex_.try_lock_shared_for(timeout);
+  }
+
+  template <class Clock, class Duration, class M = Mutex>
+  auto try_lock_shared_until(
+      const std::chrono::time_point<Clock, Duration>& deadline)
+      -> decltype(std::declval<M&>().try_lock_shared_until(deadline)) {
+    return mutex_.try_lock_shared_until(deadline);
+  }
+
+ private:
+  Mutex mutex_;
+};
+
+#endif  // NIL_ASYNC_LOCK_STATS
+
+}  // namespace nil::async
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_INSTRUMENTEDMUTEX_HPP_
@@ -0,0 +1,64 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_JOB_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_JOB_HPP_
+
+#include <exception>
+#include <functional>
+#include <future>
+#include <type_traits>
+#include <utility>
+
+namespace nil::async::detail {
+
+/**
+ * A type-erased callable queued by strand and thread_pool. Unlike
+ * std::function it can be move-only
+ *
+ * @tparam Args - what the callable is invoked with, like T& for a strand
+ */
+template <class... Args>
+struct job {
+  virtual ~job() = default;
+  virtual void run(Args... args) = 0;
+};
+
+template <class F, class... Args>
+struct job_impl final : job<Args...> {
+  template <class U>
+  explicit job_impl(U&& u) : f{std::forward<U>(u)} {}
+
+  void run(Args... args) override {
+    std::invoke(f, std::forward<Args>(args)...);
+  }
+
+  F f;
+};
+
+/**
+ * Wraps @p f so its result (a copy, like apply) or its exception goes to a
+ * future, for the submit functions. Returns the wrapper and the future
+ */
+template <class... Args, class F>
+auto package(F&& f) {
+  using result_t =
+      std::decay_t<std::invoke_result_t<std::decay_t<F>&, Args...>>;
+  std::promise<result_t> promise;
+  auto future = promise.get_future();
+  auto wrapper = [promise = std::move(promise),
+                  f = std::forward<F>(f)](Args... args) mutable {
+    try {
+      if constexpr (std::is_void_v<result_t>) {
+        std::invoke(f, std::forward<Args>(args)...);
+        promise.set_value();
+      } else {
+        promise.set_value(std::invoke(f, std::forward<Args>(args)...));
+      }
+    } catch (...) {
+      promise.set_exception(std::current_exception());
+    }
+  };
+  return std::pair{std::move(wrapper), std::move(future)};
+}
+
+}  // namespace nil::async::detail
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_JOB_HPP_
@@ -0,0 +1,169 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_LATEST_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_LATEST_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <meta/enable_if.hpp>
+#include <thread>
+#include <utility>
+
+#include "async/adaptive_mutex.hpp"
+#include "async/cache_line.hpp"
+
+namespace nil::async {
+
+/**
+ * A latest-value channel for one writer and any number of readers, built on a
+ * ring of buffers (a triple buffer by default).
+ *
+ * The writer fills a buffer nobody is reading, then publishes it with a single
+ * atomic store, so it never waits for a reader to finish copying. Readers pin
+ * the most recently published buffer with a per-buffer reader count and read
+ * it in place, or copy it out, without any lock.
+ *
+ * Readers always see the latest complete value. Intermediate values may be
+ * skipped if the writer publishes faster than a reader looks.
+ *
+ * @note push must only be called from one thread at a time
+ * @note the writer never waits as long as at most Buffers - 2 readers are
+ * reading at once. Beyond that it spins until a reader lets go of a buffer, so
+ * size Buffers for the number of reader threads, and don't hold read proxies
+ * for long
+ *
+ * @tparam T - a default constructible, assignable type. Buffers are reused,
+ * so pushing into a vector or string reuses its capacity
+ * @tparam Buffers - number of buffers, at least 3
+ */
+template <class T, std::size_t Buffers = 3>
+class latest {
+  static_assert(Buffers >= 3, "latest needs at least 3 buffers");
+
+  struct alignas(cache_line_size) buffer {
+    mutable std::atomic<std::uint32_t> readers{0};
+    T value{};
+  };
+
+ public:
+  using value_type = T;
+
+  /**
+   * Const access to the buffer that was current when it was created. The
+   * writer won't touch that buffer until the proxy is destroyed
+   */
+  class read_proxy {
+   public:
+    read_proxy(const read_proxy&) = delete;
+    read_proxy& operator=(const read_proxy&) = delete;
+    read_proxy(read_proxy&& other) noexcept
+        : b_{std::exchange(other.b_, nullptr)} {}
+    read_proxy& operator=(read_proxy&&) = delete;
+
+    ~read_proxy() {
+      if (b_) {
+        b_->readers.fetch_sub(1, std::memory_order_release);
+      }
+    }
+
+    const T& operator*() const { return b_->value; }
+    const T* operator->() const { return &b_->value; }
+    const T& value() const { return b_->value; }
+
+   private:
+    friend class latest;
+    explicit read_proxy(const buffer& b) : b_{&b} {}
+
+    const buffer* b_;
+  };
+
+  // constructors --------------------------------------------------------------
+
+  latest() = default;
+
+  /** publishes @p init as the first value */
+  template <class U = T, if_assignable<T&, U&&>* = nullptr>
+  explicit latest(U&& init) {
+    buffers_[0].value = std::forward<U>(init);
+  }
+
+  // no copying/moving ---------------------------------------------------------
+
+  latest(const latest&) = delete;
+  latest& operator=(const latest&) = delete;
+  latest(latest&&) = delete;
+  latest& operator=(latest&&) = delete;
+
+  // writer --------------------------------------------------------------------
+
+  /** assigns @p u into a free buffer, then publishes it */
+  template <class U = T, class = if_assignable<T&, U&&>>
+  void push(U&& u) {
+    const auto ii = claim();
+    buffers_[ii].value = std::forward<U>(u);
+    current_.store(ii, std::memory_order_seq_cst);
+  }
+
+  // readers -------------------------------------------------------------------
+
+  /** copy of the latest value, taken without locking */
+  T peek() const {
+    const auto proxy = read();
+    return *proxy;
+  }
+
+  /** copy-assigns the latest value into @p out, reusing its storage */
+  void peek_into(T& out) const {
+    const auto proxy = read();
+    out = *proxy;
+  }
+
+  /** zero-copy access to the latest value */
+  read_proxy read() const { return read_proxy{buffers_[pin()]}; }
+
+  // state observers -----------------------------------------------------------
+
+  static constexpr std::size_t buffer_count() noexcept { return Buffers; }
+
+ private:
+  /**
+   * Registers as a reader of the current buffer. If the writer published
+   * another one in the meantime, it may already be writing to this one, so
+   * back out and retry. The seq_cst pairs with claim(), which checks the reader
+   * counts after publishing
+   */
+  std::size_t pin() const noexcept {
+    for (;;) {
+      const auto ii = current_.load(std::memory_order_seq_cst);
+      buffers_[ii].readers.fetch_add(1, std::memory_order_seq_cst);
+      if (current_.load(std::memory_order_seq_cst) == ii) {
+        return ii;
+      }
+      buffers_[ii].readers.fetch_sub(1, std::memory_order_release);
+    }
+  }
+
+  /** finds a buffer that's neither published nor being read */
+  std::size_t claim() noexcept {
+    const auto published = current_.load(std::memory_order_relaxed);
+    for (int spins{0};; spins++) {
+      for (std::size_t jj{1}; jj < Buffers; jj++) {
+        const auto ii = (published + jj) % Buffers;
+        if (buffers_[ii].readers.load(std::memory_order_seq_cst) == 0) {
+          return ii;
+        }
+      }
+      if (spins < 64) {
+        cpu_relax();
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  std::array<buffer, Buffers> buffers_;
+  alignas(cache_line_size) std::atomic<std::size_t> current_{0};
+};
+
+}  // namespace nil::async
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_LATEST_HPP_
@@ -0,0 +1,51 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_LAYOUT_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_LAYOUT_HPP_
+
+#include <cstddef>
+
+#include "async/cache_line.hpp"
+
+/**
+ * Layout policies for the Layout parameter of atomic_base, atomic_rw_base,
+ * optional_base and container_base. They decide where the mutex and the data
+ * sit relative to cache lines.
+ *
+ * Each policy gives the alignment of the mutex and of the data. Members are
+ * aligned to the larger of that and their natural alignment, so 1 leaves them
+ * where they would be anyway.
+ */
+namespace nil::async::layout {
+
+/**
+ * Mutex and data back to back, with no padding. The smallest layout, but
+ * neighbouring instances in an array share cache lines, so threads working on
+ * "their own" instance still slow each other down (false sharing)
+ */
+struct compact {
+  static constexpr std::size_t mutex_alignment = 1;
+  static constexpr std::size_t data_alignment = 1;
+};
+
+/**
+ * Each instance starts on its own cache line and is padded to a whole number
+ * of lines, so neighbouring instances never share one. Use this for arrays of
+ * per-thread or per-worker instances
+ */
+struct padded {
+  static constexpr std::size_t mutex_alignment = cache_line_size;
+  static constexpr std::size_t data_alignment = 1;
+};
+
+/**
+ * Like padded, and the data also starts on a new cache line. Threads spinning
+ * on (or queueing for) the mutex then don't keep evicting the line the owner
+ * is writing the data to. The largest layout
+ */
+struct split {
+  static constexpr std::size_t mutex_alignment = cache_line_size;
+  static constexpr std::size_t data_alignment = cache_line_size;
+};
+
+}  // namespace nil::async::layout
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_LAYOUT_HPP_
@@ -0,0 +1,61 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_LOCKACCESS_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_LOCKACCESS_HPP_
+
+namespace nil::async::detail {
+
+/**
+ * Reaches into the mutex and data of the wrapper classes, which declare it a
+ * friend, so nil::apply_all can lock several of them at once. Not for use
+ * anywhere else: everything it hands out must only be touched with the
+ * wrapper's own locking protocol, see apply_all.hpp
+ */
+struct lock_access {
+  template <class W>
+  static auto& mutex(const W& w) noexcept {
+    return w.mutex_;
+  }
+
+  /** the data of atomic_base, atomic_rw_base and optional_base */
+  template <class W>
+  static auto& value(W& w) noexcept {
+    return w.t_;
+  }
+
+  /** the data of container_base */
+  template <class W>
+  static auto& elements(W& w) noexcept {
+    return w.c_;
+  }
+
+  /** the change_signal of atomic_base and optional_base */
+  template <class W>
+  static auto& signal(W& w) noexcept {
+    return w.signal_;
+  }
+
+  /**
+   * the gate writers of atomic_rw_base pass before the exclusive lock, only
+   * if it has an UpgradeMutex
+   */
+  template <class W>
+  static auto& upgrade_gate(W& w) noexcept {
+    return w.upgrade_mutex_;
+  }
+
+  /** bumps the version of atomic_rw_base, with the write lock held */
+  template <class W>
+  static void changed(W& w) noexcept {
+    w.changed();
+  }
+
+  /**
+   * Wakes the waiters of container_base, threads and coroutines alike, once
+   * it's destroyed. arm() must be called with the lock held
+   */
+  template <class W>
+  using notifier = typename W::notifier;
+};
+
+}  // namespace nil::async::detail
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_LOCKACCESS_HPP_
@@ -0,0 +1,203 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_LOCKSTATS_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_LOCKSTATS_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace nil::async {
+
+/**
+ * Histogram of durations with power of two buckets. Bucket `ii` counts
+ * durations in [2^(ii-1), 2^ii) nanoseconds, bucket 0 counts zero.
+ */
+class duration_histogram {
+ public:
+  static constexpr std::size_t bucket_count = 40;  //!< up to ~9 minutes
+  using counts_type = std::array<std::uint64_t, bucket_count>;
+
+  void record(std::chrono::nanoseconds d) noexcept {
+    buckets_[bucket_for(d.count())].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  counts_type counts() const noexcept {
+    counts_type out{};
+    for (std::size_t ii{0}; ii < bucket_count; ii++) {
+      out[ii] = buckets_[ii].load(std::memory_order_relaxed);
+    }
+    return out;
+  }
+
+  /** upper bound (in ns) of the bucket holding the @p p th percentile */
+  static std::uint64_t percentile(const counts_type& counts, double p) {
+    std::uint64_t total{0};
+    for (auto c : counts) {
+      total += c;
+    }
+    if (total == 0) {
+      return 0;
+    }
+    const auto rank = static_cast<std::uint64_t>(p / 100.0 * total);
+    std::uint64_t seen{0};
+    for (std::size_t ii{0}; ii < bucket_count; ii++) {
+      seen += counts[ii];
+      if (seen > rank) {
+        return ii == 0 ? 0 : std::uint64_t{1} << ii;
+      }
+    }
+    return std::uint64_t{1} << (bucket_count - 1);
+  }
+
+ private:
+  static std::size_t bucket_for(std::int64_t ns) noexcept {
+    std::size_t ii{0};
+    for (auto v = static_cast<std::uint64_t>(ns < 0 ? 0 : ns); v != 0;
+         v >>= 1) {
+      ii++;
+    }
+    return ii < bucket_count ? ii : bucket_count - 1;
+  }
+
+  std::array<std::atomic<std::uint64_t>, bucket_count> buckets_{};
+};
+
+/**
+ * Counters for every lock registered under one name. All updates are relaxed
+ * atomics, so readers only get an approximate, but never torn, view.
+ */
+struct lock_stats {
+  std::atomic<std::uint64_t> acquisitions{0};
+  std::atomic<std::uint64_t> contended{0};  //!< had to wait for the lock
+  duration_histogram wait;                  //!< contended acquisitions only
+  duration_histogram hold;                  //!< exclusive acquisitions only
+};
+
+/** a copy of one entry of the lock_registry */
+struct lock_stats_snapshot {
+  std::string name;
+  std::uint64_t acquisitions;
+  std::uint64_t contended;
+  duration_histogram::counts_type wait;
+  duration_histogram::counts_type hold;
+};
+
+/**
+ * Process-wide registry of lock_stats, by name. Every lock registered under
+ * the same name shares one entry, so e.g. all the per-session maps can be
+ * looked at together. Entries outlive the locks that fed them.
+ */
+class lock_registry {
+ public:
+  static constexpr const char* unnamed = "unnamed";
+
+  /** process-wide registry */
+  static lock_registry& global() {
+    static lock_registry registry;
+    return registry;
+  }
+
+  /** finds or creates the entry for @p name */
+  std::shared_ptr<lock_stats> stats_for(const std::string& name) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    auto& stats = stats_[name];
+    if (!stats) {
+      stats = std::make_shared<lock_stats>();
+    }
+    return stats;
+  }
+
+  /** copies every entry, ordered by name */
+  std::vector<lock_stats_snapshot> snapshot() const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    std::vector<lock_stats_snapshot> out;
+    out.reserve(stats_.size());
+    for (const auto& [name, stats] : stats_) {
+      out.push_back({name, stats->acquisitions.load(std::memory_order_relaxed),
+                     stats->contended.load(std::memory_order_relaxed),
+                     stats->wait.counts(), stats->hold.counts()});
+    }
+    return out;
+  }
+
+  /** drops every entry. Locks keep feeding the entries they already hold */
+  void clear() {
+    std::lock_guard<std::mutex> lock{mutex_};
+    stats_.clear();
+  }
+
+  // dump ----------------------------------------------------------------------
+
+  /** one line per name, durations are bucket upper bounds in ns */
+  void dump_text(std::ostream& os) const {
+    using histogram = duration_histogram;
+    os << std::left << std::setw(32) << "lock" << std::right << std::setw(14)
+       << "acquisitions" << std::setw(12) << "contended" << std::setw(12)
+       << "wait p50" << std::setw(12) << "wait p99" << std::setw(12)
+       << "hold p50" << std::setw(12) << "hold p99" << '\n';
+    for (const auto& s : snapshot()) {
+      os << std::left << std::setw(32) << s.name << std::right
+         << std::setw(14) << s.acquisitions << std::setw(12) << s.contended
+         << std::setw(12) << histogram::percentile(s.wait, 50)
+         << std::setw(12) << histogram::percentile(s.wait, 99)
+         << std::setw(12) << histogram::percentile(s.hold, 50)
+         << std::setw(12) << histogram::percentile(s.hold, 99) << '\n';
+    }
+  }
+
+  /** an array of objects, with the full histograms as arrays of counts */
+  void dump_json(std::ostream& os) const {
+    const auto write_counts = [&os](const auto& counts) {
+      os << '[';
+      for (std::size_t ii{0}; ii < counts.size(); ii++) {
+        os << (ii ? "," : "") << counts[ii];
+      }
+      os << ']';
+    };
+
+    os << '[';
+    bool first = true;
+    for (const auto& s : snapshot()) {
+      os << (first ? "" : ",") << "{\"name\":";
+      write_json_string(os, s.name);
+      os << ",\"acquisitions\":" << s.acquisitions
+         << ",\"contended\":" << s.contended << ",\"wait_ns_log2\":";
+      write_counts(s.wait);
+      os << ",\"hold_ns_log2\":";
+      write_counts(s.hold);
+      os << '}';
+      first = false;
+    }
+    os << ']';
+  }
+
+ private:
+  static void write_json_string(std::ostream& os, const std::string& str) {
+    os << '"';
+    for (const auto c : str) {
+      if (c == '"' || c == '\\') {
+        os << '\\' << c;
+      } else if (static_cast<unsigned char>(c) < 0x20) {
+        os << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+           << static_cast<int>(c) << std::dec << std::setfill(' ');
+      } else {
+        os << c;
+      }
+    }
+    os << '"';
+  }
+
+  mutable std::mutex mutex_;
+  std::map<std::string, std::shared_ptr<lock_stats>> stats_;
+};
+
+}  // namespace nil::async
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_LOCKSTATS_HPP_
@@ -0,0 +1,174 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_MPMCQUEUE_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_MPMCQUEUE_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <meta/enable_if.hpp>
+#include <new>
+#include <optional>
+
+#include "async/cache_line.hpp"
+
+namespace nil::async {
+
+/**
+ * Bounded, lock-free multi-producer multi-consumer queue. An alternative to
+ * nil::async::deque when it's only used as a work queue through push_back and
+ * extract_front.
+ *
+ * Based on Dmitry Vyukov's bounded MPMC queue: every slot carries a sequence
+ * number that tells producers and consumers whether it's their turn, so the
+ * only shared writes are one CAS on the head or tail per operation. Head and
+ * tail live on separate cache lines.
+ *
+ * Unlike the containers, this never blocks and never allocates after
+ * construction, but it has a fixed capacity. try_push fails when full, and
+ * try_pop returns std::nullopt when empty, the same way extract_front does.
+ *
+ * @note the value is constructed before a slot is claimed, so a throwing
+ * constructor leaves the queue untouched
+ *
+ * @tparam T - any nothrow move constructible type, including move-only types
+ */
+template <class T>
+class mpmc_queue {
+  static_assert(std::is_nothrow_move_constructible_v<T>,
+                "T must be nothrow move constructible");
+
+  struct slot {
+    std::atomic<std::size_t> seq;
+    alignas(T) unsigned char storage[sizeof(T)];
+
+    T* ptr() { return std::launder(reinterpret_cast<T*>(storage)); }
+  };
+
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+
+  // constructors --------------------------------------------------------------
+
+  /** @param capacity - rounded up to the next power of two, at least 2 */
+  explicit mpmc_queue(size_type capacity)
+      : mask_{round_up(capacity) - 1},
+        slots_{std::make_unique<slot[]>(mask_ + 1)} {
+    for (size_type ii{0}; ii <= mask_; ii++) {
+      slots_[ii].seq.store(ii, std::memory_order_relaxed);
+    }
+  }
+
+  ~mpmc_queue() {
+    while (try_pop()) {
+    }
+  }
+
+  // no copying/moving ---------------------------------------------------------
+
+  mpmc_queue(const mpmc_queue&) = delete;
+  mpmc_queue& operator=(const mpmc_queue&) = delete;
+  mpmc_queue(mpmc_queue&&) = delete;
+  mpmc_queue& operator=(mpmc_queue&&) = delete;
+
+  // Insertion -----------------------------------------------------------------
+
+  /** returns false, leaving @p v untouched, if the queue is full */
+  template <class V = value_type, if_constructible<T, V&&>* = nullptr>
+  bool try_push(V&& v) {
+    if constexpr (std::is_same_v<V, T>) {
+      return try_push_value(std::forward<V>(v));
+    } else {
+      return try_push_value(T(std::forward<V>(v)));
+    }
+  }
+
+  /** returns false if the queue is full */
+  template <class... Args, if_constructible<T, Args&&...>* = nullptr>
+  bool try_emplace(Args&&... args) {
+    return try_push_value(T(std::forward<Args>(args)...));
+  }
+
+  // Remove --------------------------------------------------------------------
+
+  std::optional<value_type> try_pop() {
+    auto pos = head_.load(std::memory_order_relaxed);
+    slot* s;
+    while (true) {
+      s = &slots_[pos & mask_];
+      const auto seq = s->seq.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::intptr_t>(seq - (pos + 1));
+      if (diff == 0) {
+        if (head_.compare_exchange_weak(pos, pos + 1,
+                                        std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return std::nullopt;  // empty
+      } else {
+        pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+
+    std::optional<value_type> v{std::move(*s->ptr())};
+    s->ptr()->~T();
+    s->seq.store(pos + mask_ + 1, std::memory_order_release);
+    return v;
+  }
+
+  // state observers -----------------------------------------------------------
+
+  size_type capacity() const noexcept { return mask_ + 1; }
+
+  /** only a snapshot, may be stale by the time it returns */
+  size_type size() const noexcept {
+    const auto head = head_.load(std::memory_order_acquire);
+    const auto tail = tail_.load(std::memory_order_acquire);
+    return tail > head ? tail - head : 0;
+  }
+
+  /** only a snapshot, may be stale by the time it returns */
+  bool empty() const noexcept { return size() == 0; }
+
+ private:
+  static size_type round_up(size_type capacity) {
+    size_type pow2 = 2;
+    while (pow2 < capacity) {
+      pow2 <<= 1;
+    }
+    return pow2;
+  }
+
+  /** @p v is only moved from if a slot was claimed */
+  bool try_push_value(T&& v) {
+    auto pos = tail_.load(std::memory_order_relaxed);
+    slot* s;
+    while (true) {
+      s = &slots_[pos & mask_];
+      const auto seq = s->seq.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::intptr_t>(seq - pos);
+      if (diff == 0) {
+        if (tail_.compare_exchange_weak(pos, pos + 1,
+                                        std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;  // full
+      } else {
+        pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+
+    ::new (static_cast<void*>(s->storage)) T(std::move(v));
+    s->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  const size_type mask_;
+  const std::unique_ptr<slot[]> slots_;
+  alignas(cache_line_size) std::atomic<size_type> tail_{0};
+  alignas(cache_line_size) std::atomic<size_type> head_{0};
+};
+
+}  // namespace nil::async
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_MPMCQUEUE_HPP_
@@ -1,6 +1,7 @@
 #ifndef NIL_SRC_ASYNC_INC_ASYNC_OPTIONAL_HPP_
 #define NIL_SRC_ASYNC_INC_ASYNC_OPTIONAL_HPP_
 
+#include <mutex>
 #include <optional>
 
 #include "async/optional_base.hpp"
@@ -14,6 +15,15 @@ namespace nil::async {
 template <class T>
 using optional = optional_base<T, std::optional, std::nullopt_t>;
 
+/**
+ * Same as optional, but on its own cache line(s). Prefer this for arrays of
+ * per-thread instances, so neighbours don't falsely share a cache line
+ */
+template <class T>
+using padded_optional = optional_base<T, std::optional, std::nullopt_t,
+                                      std::mutex, std::lock_guard,
+                                      layout::padded>;
+
 }  // namespace nil::async
 
 #endif  // NIL_SRC_ASYNC_INC_ASYNC_OPTIONAL_HPP_
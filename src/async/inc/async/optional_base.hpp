@@ -1,29 +1,60 @@
 #ifndef NIL_SRC_ASYNC_INC_ASYNC_OPTIONALBASE_HPP_
 #define NIL_SRC_ASYNC_INC_ASYNC_OPTIONALBASE_HPP_
 
+#include <chrono>
 #include <functional>
 #include <meta/enable_if.hpp>
 #include <mutex>
+#include <string>
+
+#include "async/change_signal.hpp"
+#include "async/layout.hpp"
+#include "async/lock_access.hpp"
+
+#ifdef NIL_ASYNC_COROUTINES
+#include <type_traits>
+
+#include "async/async_mutex.hpp"
+#include "async/task.hpp"
+#endif
 
 namespace nil::async {
 
 /**
  * Similar to the atomic class but provides an additional null state for T
  *
+ * Like atomic, wait_until and wait_for block until a predicate holds, waking
+ * after every push, pop or apply (non-const)
+ *
+ * With NIL_ASYNC_COROUTINES and an async_mutex, coroutines can co_await
+ * apply_async, which suspends them rather than the thread
+ *
  * @tparam T - any type, including move-only types
  * @tparam OptT - the underlying optional type, like std::optional
  * @tparam NullT - the null type for @tparam OptT, like std::nullopt_t
+ * @tparam Mutex - a standard mutex, like std::mutex
+ * @tparam LockGuard - an RAII lock, like std::lock_guard
+ * @tparam Layout - one of the nil::async::layout policies, defaults to compact
  */
-template <class T, template <class> class OptT, class NullT>
+template <class T, template <class> class OptT, class NullT,
+          class Mutex = std::mutex,
+          template <class> class LockGuard = std::lock_guard,
+          class Layout = layout::compact>
 class optional_base {
  public:
   using value_type = T;
   using opt_type = OptT<T>;
   using null_type = NullT;
+  using mutex_type = Mutex;
+  using lock_type_t = LockGuard<Mutex>;
+  using layout_type = Layout;
 
  private:
-  mutable std::mutex mutex_;
-  opt_type t_{};
+  using notifier = change_signal::notifier;
+
+  alignas(Layout::mutex_alignment) alignas(Mutex) mutable mutex_type mutex_;
+  mutable change_signal signal_;  //!< wakes wait_until / wait_for
+  alignas(Layout::data_alignment) alignas(opt_type) opt_type t_{};
 
  public:
   // construct with null -------------------------------------------------------
@@ -49,31 +80,39 @@ class optional_base {
 
   /** only valid if T is copyable */
   opt_type peek() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    lock_type_t lock(mutex_);
     return t_;
   }
 
   // update --------------------------------------------------------------------
 
   void push(const opt_type& opt_val) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    notifier notify{signal_};
+    lock_type_t lock(mutex_);
+    notify.changed();
     t_ = opt_val;
   }
 
   void push(opt_type&& opt_val) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    notifier notify{signal_};
+    lock_type_t lock(mutex_);
+    notify.changed();
     t_ = std::move(opt_val);
   }
 
-  template <class U = T, class = if_assignable<T, U&&>>
+  template <class U = T, class = if_assignable<T&, U&&>>
   void push(U&& u) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    notifier notify{signal_};
+    lock_type_t lock(mutex_);
+    notify.changed();
     t_ = {std::forward<U>(u)};
   }
 
   template <class... Args, if_constructible<T, Args...>* = nullptr>
   void push(std::in_place_t, Args&&... args) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    notifier notify{signal_};
+    lock_type_t lock(mutex_);
+    notify.changed();
     t_ = {{std::forward<Args>(args)...}};
   }
 
@@ -81,10 +120,12 @@ class optional_base {
 
   template <class U = T, class = if_constructible<T, U&&>>
   opt_type pop() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    notifier notify{signal_};
+    lock_type_t lock(mutex_);
     if (!t_) {
       return opt_type{};
     }
+    notify.changed();
     auto temp = std::move(t_.value());
     t_.reset();
     return {std::move(temp)};
@@ -94,15 +135,86 @@ class optional_base {
 
   template <class F>
   auto apply(F&& f) const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    lock_type_t lock(mutex_);
     return std::invoke(std::forward<F>(f), static_cast<const opt_type&>(t_));
   }
 
+  /** wakes waiters afterwards, in case @p f changed the data */
   template <class F>
   auto apply(F&& f) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    notifier notify{signal_};
+    lock_type_t lock(mutex_);
+    notify.changed();
     return std::invoke(std::forward<F>(f), static_cast<opt_type&>(t_));
   }
+
+#ifdef NIL_ASYNC_COROUTINES
+  // arbitrary function from a coroutine ---------------------------------------
+
+  /**
+   * Like apply, but co_awaiting it suspends the coroutine until the lock is
+   * free instead of blocking the thread. Needs an async_mutex. @p f is moved
+   * into the task, which must not outlive this
+   */
+  template <class F>
+  task<std::decay_t<std::invoke_result_t<F&, const opt_type&>>> apply_async(
+      F f) const {
+    co_await mutex_.lock_async();
+    lock_type_t lock(mutex_, std::adopt_lock);
+    co_return std::invoke(f, static_cast<const opt_type&>(t_));
+  }
+
+  template <class F>
+  task<std::decay_t<std::invoke_result_t<F&, opt_type&>>> apply_async(F f) {
+    notifier notify{signal_};
+    co_await mutex_.lock_async();
+    lock_type_t lock(mutex_, std::adopt_lock);
+    notify.changed();
+    co_return std::invoke(f, static_cast<opt_type&>(t_));
+  }
+#endif
+
+  // wait for a change ---------------------------------------------------------
+
+  /**
+   * Blocks until @p pred returns true for the data. @p pred is checked with the
+   * lock held, first straight away and then after every push, pop or apply
+   */
+  template <class Pred, class = if_invocable<Pred, const opt_type&>>
+  void wait_until(Pred&& pred) const {
+    signal_.wait_until<lock_type_t>(mutex_, ready(pred));
+  }
+
+  /** like wait_until, but gives up after @p timeout. Returns false if it did */
+  template <class Pred, class Rep, class Period,
+            class = if_invocable<Pred, const opt_type&>>
+  bool wait_for(Pred&& pred,
+                const std::chrono::duration<Rep, Period>& timeout) const {
+    using clock = change_signal::clock;
+    const auto deadline =
+        clock::now() + std::chrono::duration_cast<clock::duration>(timeout);
+    return signal_.wait_until<lock_type_t>(mutex_, ready(pred), deadline);
+  }
+
+  // instrumentation -----------------------------------------------------------
+
+  /**
+   * Names this instance in the lock_registry. Only compiles if the mutex
+   * supports it, like instrumented_mutex
+   */
+  void set_lock_name(const std::string& name) { mutex_.set_name(name); }
+
+ private:
+  friend struct detail::lock_access;  //!< for apply_all
+
+  /** @p pred bound to the data, to be called with the lock held */
+  template <class Pred>
+  auto ready(Pred& pred) const {
+    return [this, &pred]() {
+      return static_cast<bool>(
+          std::invoke(pred, static_cast<const opt_type&>(t_)));
+    };
+  }
 };
 
 }  // namespace nil::async
@@ -0,0 +1,170 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_RECLAIMBASE_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_RECLAIMBASE_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace nil::async {
+
+/**
+ * Shared bookkeeping for the memory reclamation domains (epoch_domain and
+ * hazard_domain). Not intended to be used directly.
+ */
+
+/** a type-erased pointer that has been unlinked and is waiting to be freed */
+struct retired_ptr {
+  void* p;
+  void (*deleter)(void*);
+  std::uint64_t epoch;  //!< only meaningful for epoch_domain
+
+  void reclaim() const { deleter(p); }
+};
+
+/** type-erases a stateless deleter @tparam D for @tparam T */
+template <class T, class D>
+void erased_delete(void* p) {
+  D{}(static_cast<T*>(p));
+}
+
+/**
+ * Lock-free, grow-only list of per-thread records. A record is claimed by one
+ * thread at a time, and handed back when that thread exits, so records are
+ * reused rather than freed. Garbage an exited thread couldn't free yet is
+ * adopted by the next thread that collects.
+ *
+ * @tparam Record - must have `std::atomic<bool> in_use`, `Record* next` and a
+ * `std::vector<retired_ptr> garbage`
+ */
+template <class Record>
+class record_registry {
+ public:
+  record_registry() = default;
+  record_registry(const record_registry&) = delete;
+  record_registry& operator=(const record_registry&) = delete;
+
+  /** frees every record and whatever garbage is left in them */
+  ~record_registry() {
+    reclaim_all();
+    auto* r = head_.load(std::memory_order_acquire);
+    while (r) {
+      auto* next = r->next;
+      delete r;
+      r = next;
+    }
+  }
+
+  Record* acquire() {
+    for (auto* r = head_.load(std::memory_order_acquire); r; r = r->next) {
+      bool expected = false;
+      if (!r->in_use.load(std::memory_order_relaxed) &&
+          r->in_use.compare_exchange_strong(expected, true,
+                                            std::memory_order_acq_rel)) {
+        return r;
+      }
+    }
+
+    auto* r = new Record{};
+    r->in_use.store(true, std::memory_order_relaxed);
+    r->next = head_.load(std::memory_order_relaxed);
+    while (!head_.compare_exchange_weak(r->next, r, std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+    }
+    return r;
+  }
+
+  void release(Record* r) { r->in_use.store(false, std::memory_order_release); }
+
+  /** moves garbage left behind by exited threads into @p out */
+  void adopt_orphans(std::vector<retired_ptr>& out) {
+    for (auto* r = head_.load(std::memory_order_acquire); r; r = r->next) {
+      bool expected = false;
+      if (!r->in_use.load(std::memory_order_relaxed) &&
+          r->in_use.compare_exchange_strong(expected, true,
+                                            std::memory_order_acq_rel)) {
+        out.insert(out.end(), r->garbage.cbegin(), r->garbage.cend());
+        r->garbage.clear();
+        release(r);
+      }
+    }
+  }
+
+  /**
+   * frees all garbage in every record, only valid once nothing can reach it,
+   * ie. when the owning domain is destroyed
+   */
+  void reclaim_all() {
+    for (auto* r = head_.load(std::memory_order_acquire); r; r = r->next) {
+      for (const auto& g : r->garbage) {
+        g.reclaim();
+      }
+      r->garbage.clear();
+    }
+  }
+
+  /** visits every record, including ones not currently claimed */
+  template <class F>
+  void for_each(F&& f) const {
+    for (auto* r = head_.load(std::memory_order_acquire); r; r = r->next) {
+      f(*r);
+    }
+  }
+
+ private:
+  std::atomic<Record*> head_{nullptr};
+};
+
+/**
+ * Returns the calling thread's record in @p state, claiming one on first use.
+ *
+ * The thread holds a shared_ptr to the state, so a domain may be destroyed
+ * while other threads still have records in it. Records are released when the
+ * thread exits, or earlier if the thread notices the domain is gone.
+ *
+ * @note domains free all remaining garbage when destroyed, so the records
+ * outliving them are empty
+ *
+ * @tparam State - must have `record_registry<...> records` and `record_type`
+ */
+template <class State>
+typename State::record_type& local_record(const std::shared_ptr<State>& state) {
+  using record_type = typename State::record_type;
+
+  struct local_records {
+    std::vector<std::pair<std::shared_ptr<State>, record_type*>> entries;
+    ~local_records() {
+      for (auto& [s, r] : entries) {
+        s->records.release(r);
+      }
+    }
+  };
+  thread_local local_records local;
+
+  for (auto& [s, r] : local.entries) {
+    if (s == state) {
+      return *r;
+    }
+  }
+
+  // we're the only owner left of any domain with use_count 1, so drop them
+  auto& entries = local.entries;
+  entries.erase(std::remove_if(entries.begin(), entries.end(),
+                               [](auto& e) {
+                                 if (e.first.use_count() != 1) {
+                                   return false;
+                                 }
+                                 e.first->records.release(e.second);
+                                 return true;
+                               }),
+                entries.end());
+
+  entries.emplace_back(state, state->records.acquire());
+  return *entries.back().second;
+}
+
+}  // namespace nil::async
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_RECLAIMBASE_HPP_
@@ -0,0 +1,19 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_SEQLOCKATOMIC_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_SEQLOCKATOMIC_HPP_
+
+#include <mutex>
+
+#include "async/seqlock_atomic_base.hpp"
+
+namespace nil {
+
+/**
+ * Specialized for std::mutex with std::lock_guard for writers. Readers are
+ * lock-free regardless of the mutex type.
+ */
+template <class T>
+using seqlock_atomic = seqlock_atomic_base<T, std::mutex, std::lock_guard>;
+
+}  // namespace nil
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_SEQLOCKATOMIC_HPP_
@@ -0,0 +1,154 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_SEQLOCKATOMICBASE_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_SEQLOCKATOMICBASE_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <meta/enable_if.hpp>
+#include <thread>
+
+namespace nil {
+
+/**
+ * Same idea as atomic_base, but readers never take a lock. Writers are
+ * serialized with a mutex and bump a sequence counter before and after every
+ * change, and readers retry until they copy the data without seeing a change.
+ *
+ * Readers never write to shared memory, so read throughput scales with cores.
+ * The trade-off is that readers may spin while a writer is mid-update, so this
+ * is best for read-mostly data that is cheap to copy.
+ *
+ * The data is stored as an array of atomic words so concurrent copies are
+ * well-defined, hence the requirement on T.
+ *
+ * @note const apply executes on a snapshot, not under a lock
+ *
+ * @tparam T - a trivially copyable, default constructible type
+ * @tparam Mutex - a standard mutex, like std::mutex, for serializing writers
+ * @tparam LockGuard - an RAII lock, like std::lock_guard
+ */
+template <class T, class Mutex, template <class> class LockGuard>
+class seqlock_atomic_base {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "T must be trivially copyable");
+  static_assert(std::is_default_constructible_v<T>,
+                "T must be default constructible");
+
+  using word_type = std::size_t;
+  static constexpr auto num_words =
+      (sizeof(T) + sizeof(word_type) - 1) / sizeof(word_type);
+  using buffer_type = std::array<word_type, num_words>;
+
+ public:
+  using value_type = T;
+  using mutex_type = Mutex;
+  using lock_type_t = LockGuard<Mutex>;
+
+  // constructors --------------------------------------------------------------
+
+  seqlock_atomic_base() { store(T{}); }
+
+  template <class... Args>
+  seqlock_atomic_base(Args&&... args) {
+    store(T{std::forward<Args>(args)...});
+  }
+
+  // deleted copy and move constructors and assignment -------------------------
+
+  seqlock_atomic_base(const seqlock_atomic_base&) = delete;
+  seqlock_atomic_base& operator=(const seqlock_atomic_base&) = delete;
+  seqlock_atomic_base(seqlock_atomic_base&&) = delete;
+  seqlock_atomic_base& operator=(seqlock_atomic_base&&) = delete;
+
+  // get a copy of data --------------------------------------------------------
+
+  T peek() const {
+    buffer_type buf;
+    while (true) {
+      const auto seq_before = seq_.load(std::memory_order_acquire);
+      if (seq_before & 1) {
+        std::this_thread::yield();  // writer in progress
+        continue;
+      }
+      for (std::size_t ii{0}; ii < num_words; ii++) {
+        buf[ii] = words_[ii].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (seq_.load(std::memory_order_relaxed) == seq_before) {
+        break;
+      }
+    }
+    T t;
+    std::memcpy(static_cast<void*>(&t), buf.data(), sizeof(T));
+    return t;
+  }
+
+  // mutate data ---------------------------------------------------------------
+
+  template <class U = T, class = if_assignable<T&, U&&>>
+  void push(U&& u) {
+    T t;
+    t = std::forward<U>(u);
+    lock_type_t lock(mutex_);
+    store(t);
+  }
+
+  // execute arbitary function on data -----------------------------------------
+
+  /** invokes @p f on a consistent snapshot, without locking */
+  template <class F>
+  auto apply(F&& f) const {
+    const T t = peek();
+    return std::invoke(std::forward<F>(f), t);
+  }
+
+  /** invokes @p f with exclusive access, readers see the result atomically */
+  template <class F>
+  auto apply(F&& f) {
+    lock_type_t lock(mutex_);
+    T t = load_locked();
+    if constexpr (std::is_void_v<std::invoke_result_t<F, T&>>) {
+      std::invoke(std::forward<F>(f), t);
+      store(t);
+    } else {
+      auto ret = std::invoke(std::forward<F>(f), t);
+      store(t);
+      return ret;
+    }
+  }
+
+ private:
+  /** only valid while holding the writer mutex, or during construction */
+  T load_locked() const {
+    buffer_type buf;
+    for (std::size_t ii{0}; ii < num_words; ii++) {
+      buf[ii] = words_[ii].load(std::memory_order_relaxed);
+    }
+    T t;
+    std::memcpy(static_cast<void*>(&t), buf.data(), sizeof(T));
+    return t;
+  }
+
+  /** only valid while holding the writer mutex, or during construction */
+  void store(const T& t) {
+    buffer_type buf{};
+    std::memcpy(buf.data(), &t, sizeof(T));
+
+    const auto seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (std::size_t ii{0}; ii < num_words; ii++) {
+      words_[ii].store(buf[ii], std::memory_order_relaxed);
+    }
+    seq_.store(seq + 2, std::memory_order_release);
+  }
+
+  mutable mutex_type mutex_;
+  std::atomic<std::size_t> seq_{0};
+  std::array<std::atomic<word_type>, num_words> words_{};
+};
+
+}  // namespace nil
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_SEQLOCKATOMICBASE_HPP_
@@ -0,0 +1,21 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_SPINATOMIC_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_SPINATOMIC_HPP_
+
+#include <mutex>
+
+#include "async/adaptive_mutex.hpp"
+#include "async/atomic_base.hpp"
+
+namespace nil {
+
+/**
+ * Specialized for nil::async::adaptive_mutex with std::lock_guard. Prefer this
+ * over nil::atomic when the critical sections are short, like peek and push
+ * on small types
+ */
+template <class T>
+using spin_atomic = atomic_base<T, async::adaptive_mutex, std::lock_guard>;
+
+}  // namespace nil
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_SPINATOMIC_HPP_
@@ -0,0 +1,23 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_SPINDEQUE_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_SPINDEQUE_HPP_
+
+#include <deque>
+#include <mutex>
+
+#include "async/adaptive_mutex.hpp"
+#include "async/container_base.hpp"
+
+namespace nil::async {
+
+/**
+ * Partially specified alias when using container_base with std::deque,
+ * adaptive_mutex and std::lock_guard. Prefer this over deque when the
+ * critical sections are short, like push_back and extract_front
+ */
+template <class T, class... Params>
+using spin_deque =
+    container_base<std::deque<T, Params...>, adaptive_mutex, std::lock_guard>;
+
+}  // namespace nil::async
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_SPINDEQUE_HPP_
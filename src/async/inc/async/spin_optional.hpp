@@ -0,0 +1,22 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_SPINOPTIONAL_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_SPINOPTIONAL_HPP_
+
+#include <mutex>
+#include <optional>
+
+#include "async/adaptive_mutex.hpp"
+#include "async/optional_base.hpp"
+
+namespace nil::async {
+
+/**
+ * Partially specified alias for std::optional guarded by an adaptive_mutex.
+ * Prefer this over nil::async::optional when the critical sections are short
+ */
+template <class T>
+using spin_optional = optional_base<T, std::optional, std::nullopt_t,
+                                    adaptive_mutex, std::lock_guard>;
+
+}  // namespace nil::async
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_SPINOPTIONAL_HPP_
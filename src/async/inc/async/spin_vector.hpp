@@ -0,0 +1,23 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_SPINVECTOR_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_SPINVECTOR_HPP_
+
+#include <mutex>
+#include <vector>
+
+#include "async/adaptive_mutex.hpp"
+#include "async/container_base.hpp"
+
+namespace nil::async {
+
+/**
+ * Partially specified alias when using container_base with std::vector,
+ * adaptive_mutex and std::lock_guard. Prefer this over vector when the
+ * critical sections are short, like push_back and at
+ */
+template <class T, class... Params>
+using spin_vector =
+    container_base<std::vector<T, Params...>, adaptive_mutex, std::lock_guard>;
+
+}  // namespace nil::async
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_SPINVECTOR_HPP_
@@ -0,0 +1,204 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_SPSCQUEUE_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_SPSCQUEUE_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <meta/enable_if.hpp>
+#include <new>
+#include <optional>
+
+#include "async/cache_line.hpp"
+
+namespace nil::async {
+
+/**
+ * Bounded, wait-free single-producer single-consumer ring buffer, for pipeline
+ * stages where exactly one thread pushes and exactly one thread pops.
+ *
+ * The producer and consumer each own one index on its own cache line, and
+ * keep a cached copy of the other side's index. They only re-read the other
+ * side's index when the cached copy says the queue is full (or empty), so in
+ * steady state a hand-off touches no shared cache lines besides the slot.
+ *
+ * push_n/pop_n move a whole batch with a single index update.
+ *
+ * @note calling the push functions from more than one thread, or the pop
+ * functions from more than one thread, is undefined behaviour
+ *
+ * @tparam T - any move constructible type, including move-only types
+ */
+template <class T>
+class spsc_queue {
+  struct slot {
+    alignas(T) unsigned char storage[sizeof(T)];
+
+    T* ptr() { return std::launder(reinterpret_cast<T*>(storage)); }
+  };
+
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+
+  // constructors --------------------------------------------------------------
+
+  /** @param capacity - rounded up to the next power of two */
+  explicit spsc_queue(size_type capacity)
+      : mask_{round_up(capacity) - 1},
+        slots_{std::make_unique<slot[]>(mask_ + 1)} {}
+
+  ~spsc_queue() {
+    while (try_pop()) {
+    }
+  }
+
+  // no copying/moving ---------------------------------------------------------
+
+  spsc_queue(const spsc_queue&) = delete;
+  spsc_queue& operator=(const spsc_queue&) = delete;
+  spsc_queue(spsc_queue&&) = delete;
+  spsc_queue& operator=(spsc_queue&&) = delete;
+
+  // Insertion, producer only --------------------------------------------------
+
+  /** returns false if the queue is full */
+  template <class V = value_type, if_constructible<T, V&&>* = nullptr>
+  bool try_push(V&& v) {
+    return try_emplace(std::forward<V>(v));
+  }
+
+  /** returns false if the queue is full */
+  template <class... Args, if_constructible<T, Args&&...>* = nullptr>
+  bool try_emplace(Args&&... args) {
+    const auto w = producer_.index.load(std::memory_order_relaxed);
+    if (w - producer_.cached_other > mask_) {
+      producer_.cached_other = consumer_.index.load(std::memory_order_acquire);
+      if (w - producer_.cached_other > mask_) {
+        return false;
+      }
+    }
+    ::new (static_cast<void*>(slots_[w & mask_].storage))
+        T(std::forward<Args>(args)...);
+    producer_.index.store(w + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Pushes up to @p n elements starting at @p first, publishing them all at
+   * once. Elements are constructed from `*first`, so wrap the iterator in
+   * std::make_move_iterator to move them in.
+   *
+   * @return the number of elements pushed, less than @p n if the queue filled
+   */
+  template <class It>
+  size_type push_n(It first, size_type n) {
+    const auto w = producer_.index.load(std::memory_order_relaxed);
+    auto free = capacity() - (w - producer_.cached_other);
+    if (free < n) {
+      producer_.cached_other = consumer_.index.load(std::memory_order_acquire);
+      free = capacity() - (w - producer_.cached_other);
+    }
+    const auto count = std::min(n, free);
+
+    size_type ii{0};
+    try {
+      for (; ii < count; ii++, ++first) {
+        auto* storage = slots_[(w + ii) & mask_].storage;
+        ::new (static_cast<void*>(storage)) T(*first);
+      }
+    } catch (...) {
+      producer_.index.store(w + ii, std::memory_order_release);
+      throw;
+    }
+    producer_.index.store(w + count, std::memory_order_release);
+    return count;
+  }
+
+  // Remove, consumer only -----------------------------------------------------
+
+  std::optional<value_type> try_pop() {
+    const auto r = consumer_.index.load(std::memory_order_relaxed);
+    if (r == consumer_.cached_other) {
+      consumer_.cached_other = producer_.index.load(std::memory_order_acquire);
+      if (r == consumer_.cached_other) {
+        return std::nullopt;
+      }
+    }
+    auto* p = slots_[r & mask_].ptr();
+    std::optional<value_type> v{std::move(*p)};
+    p->~T();
+    consumer_.index.store(r + 1, std::memory_order_release);
+    return v;
+  }
+
+  /**
+   * Moves up to @p n elements into @p out, releasing their slots all at once.
+   * If writing to @p out throws, the elements already written are released
+   * and the rest, including the one that threw, stay in the queue
+   *
+   * @return the number of elements popped, less than @p n if the queue emptied
+   */
+  template <class OutIt>
+  size_type pop_n(OutIt out, size_type n) {
+    const auto r = consumer_.index.load(std::memory_order_relaxed);
+    auto available = consumer_.cached_other - r;
+    if (available < n) {
+      consumer_.cached_other = producer_.index.load(std::memory_order_acquire);
+      available = consumer_.cached_other - r;
+    }
+    const auto count = std::min(n, available);
+
+    size_type ii{0};
+    try {
+      for (; ii < count; ii++) {
+        auto* p = slots_[(r + ii) & mask_].ptr();
+        *out = std::move(*p);
+        ++out;
+        p->~T();
+      }
+    } catch (...) {
+      consumer_.index.store(r + ii, std::memory_order_release);
+      throw;
+    }
+    consumer_.index.store(r + count, std::memory_order_release);
+    return count;
+  }
+
+  // state observers -----------------------------------------------------------
+
+  size_type capacity() const noexcept { return mask_ + 1; }
+
+  /** only a snapshot, may be stale by the time it returns */
+  size_type size() const noexcept {
+    const auto r = consumer_.index.load(std::memory_order_acquire);
+    const auto w = producer_.index.load(std::memory_order_acquire);
+    return w - r;
+  }
+
+  /** only a snapshot, may be stale by the time it returns */
+  bool empty() const noexcept { return size() == 0; }
+
+ private:
+  static size_type round_up(size_type capacity) {
+    size_type pow2 = 1;
+    while (pow2 < capacity) {
+      pow2 <<= 1;
+    }
+    return pow2;
+  }
+
+  /** an index owned by one side, and that side's cache of the other index */
+  struct alignas(cache_line_size) side {
+    std::atomic<size_type> index{0};
+    size_type cached_other{0};
+  };
+
+  const size_type mask_;
+  const std::unique_ptr<slot[]> slots_;
+  side producer_;
+  side consumer_;
+};
+
+}  // namespace nil::async
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_SPSCQUEUE_HPP_
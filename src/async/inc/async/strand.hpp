@@ -0,0 +1,114 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_STRAND_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_STRAND_HPP_
+
+#include <memory>
+#include <meta/enable_if.hpp>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "async/adaptive_mutex.hpp"
+#include "async/job.hpp"
+
+namespace nil::async {
+
+/**
+ * Owns a T and runs callables on it one at a time, in the order they were
+ * posted (an actor). Unlike atomic_base::apply, callers don't wait for the
+ * lock: post() queues the callable and returns, and submit() returns a future
+ * for its result.
+ *
+ * There is no worker thread. Whichever caller finds the strand idle drains the
+ * queue, running its own callable and everything posted meanwhile by others,
+ * until it's empty. Everyone else only takes a short lock to queue theirs.
+ *
+ * @note a callable may post() to its own strand, it runs after the current
+ * batch. Waiting on the future of a submit() to its own strand deadlocks
+ * @note callables passed to post() must not throw, like a function run by
+ * std::thread. Exceptions from submit() are passed on through the future
+ * @note destroying the strand while another thread is still inside post or
+ * submit is undefined behaviour, same as for any other object
+ *
+ * @tparam T - any type, constructed in place from the constructor arguments
+ */
+template <class T>
+class strand {
+  using task = detail::job<T&>;
+
+ public:
+  using value_type = T;
+
+  // constructors --------------------------------------------------------------
+
+  template <class... Args>
+  explicit strand(Args&&... args) : t_{std::forward<Args>(args)...} {}
+
+  // no copying/moving ---------------------------------------------------------
+
+  strand(const strand&) = delete;
+  strand& operator=(const strand&) = delete;
+  strand(strand&&) = delete;
+  strand& operator=(strand&&) = delete;
+
+  // queue work ----------------------------------------------------------------
+
+  /**
+   * Queues @p f to be called with the data, after everything posted before
+   * it. Runs it straight away, along with anything posted meanwhile, if the
+   * strand is idle
+   */
+  template <class F, class = if_invocable<std::decay_t<F>&, T&>>
+  void post(F&& f) {
+    auto t = std::make_unique<detail::job_impl<std::decay_t<F>, T&>>(
+        std::forward<F>(f));
+    bool drain_now;
+    {
+      std::lock_guard<adaptive_mutex> lock{mutex_};
+      queue_.push_back(std::move(t));
+      drain_now = !draining_;
+      draining_ = true;
+    }
+    if (drain_now) {
+      drain();
+    }
+  }
+
+  /** like post, and returns a future for @p f's result (copied, like apply) */
+  template <class F, class = if_invocable<std::decay_t<F>&, T&>>
+  auto submit(F&& f) {
+    auto [wrapper, future] = detail::package<T&>(std::forward<F>(f));
+    post(std::move(wrapper));
+    return std::move(future);
+  }
+
+ private:
+  /** runs batches of tasks until the queue is empty */
+  void drain() noexcept {
+    for (;;) {
+      {
+        std::lock_guard<adaptive_mutex> lock{mutex_};
+        if (queue_.empty()) {
+          draining_ = false;
+          return;
+        }
+        using std::swap;
+        swap(queue_, batch_);
+      }
+      for (auto& t : batch_) {
+        t->run(t_);
+      }
+      batch_.clear();  // keeps the capacity, for the queue after the next swap
+    }
+  }
+
+  adaptive_mutex mutex_;  //!< only guards the queue, never held while running
+  std::vector<std::unique_ptr<task>> queue_;
+  bool draining_{false};  //!< guarded by mutex_
+  std::vector<std::unique_ptr<task>> batch_;  //!< only used by the drainer
+  T t_;                                       //!< only used by the drainer
+};
+
+}  // namespace nil::async
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_STRAND_HPP_
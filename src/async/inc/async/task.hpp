@@ -0,0 +1,231 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_TASK_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_TASK_HPP_
+
+#ifdef NIL_ASYNC_COROUTINES
+
+#if !defined(__cpp_impl_coroutine)
+#error "NIL_ASYNC_COROUTINES needs C++20 coroutines, build with -std=c++20"
+#endif
+
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace nil::async {
+
+template <class T = void>
+class task;
+
+namespace detail {
+
+/** what task<T> and task<void> have in common */
+struct task_promise_base {
+  /** resumes whoever awaited the task, once it's done */
+  struct final_awaiter {
+    bool await_ready() noexcept { return false; }
+
+    template <class P>
+    std::coroutine_handle<> await_suspend(
+        std::coroutine_handle<P> h) noexcept {
+      return h.promise().continuation;
+    }
+
+    void await_resume() noexcept {}
+  };
+
+  std::suspend_always initial_suspend() noexcept { return {}; }
+  final_awaiter final_suspend() noexcept { return {}; }
+  void unhandled_exception() noexcept { error = std::current_exception(); }
+
+  void rethrow_if_failed() {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  std::coroutine_handle<> continuation;
+  std::exception_ptr error;
+};
+
+template <class T>
+struct task_promise : task_promise_base {
+  task<T> get_return_object() noexcept;
+
+  template <class U>
+  void return_value(U&& u) {
+    value.emplace(std::forward<U>(u));
+  }
+
+  T result() {
+    rethrow_if_failed();
+    return std::move(*value);
+  }
+
+  std::optional<T> value;
+};
+
+template <>
+struct task_promise<void> : task_promise_base {
+  task<void> get_return_object() noexcept;
+  void return_void() noexcept {}
+  void result() { rethrow_if_failed(); }
+};
+
+}  // namespace detail
+
+/**
+ * A lazily started coroutine returning @tparam T, what the *_async functions
+ * of the wrapper classes return. It starts running when it's co_awaited, and
+ * resumes the awaiting coroutine when it's done, passing on its result or
+ * exception.
+ *
+ * @note only available when building with NIL_ASYNC_COROUTINES (C++20)
+ */
+template <class T>
+class [[nodiscard]] task {
+ public:
+  using promise_type = detail::task_promise<T>;
+  using handle_type = std::coroutine_handle<promise_type>;
+
+  explicit task(handle_type h) noexcept : h_{h} {}
+  task(task&& other) noexcept : h_{std::exchange(other.h_, {})} {}
+  task(const task&) = delete;
+  task& operator=(const task&) = delete;
+  task& operator=(task&&) = delete;
+
+  ~task() {
+    if (h_) {
+      h_.destroy();
+    }
+  }
+
+  /** starts the task, and suspends the caller until it's done */
+  auto operator co_await() && noexcept {
+    struct awaiter {
+      bool await_ready() noexcept { return false; }
+
+      std::coroutine_handle<> await_suspend(
+          std::coroutine_handle<> caller) noexcept {
+        h.promise().continuation = caller;
+        return h;
+      }
+
+      T await_resume() { return h.promise().result(); }
+
+      handle_type h;
+    };
+    return awaiter{h_};
+  }
+
+ private:
+  handle_type h_;
+};
+
+template <class T>
+task<T> detail::task_promise<T>::get_return_object() noexcept {
+  return task<T>{std::coroutine_handle<task_promise>::from_promise(*this)};
+}
+
+inline task<void> detail::task_promise<void>::get_return_object() noexcept {
+  return task<void>{std::coroutine_handle<task_promise>::from_promise(*this)};
+}
+
+// blocking bridge -------------------------------------------------------------
+
+namespace detail {
+
+/** a coroutine that signals a blocked thread when it finishes */
+struct sync_wait_driver {
+  struct state {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done{false};
+  };
+
+  struct promise_type {
+    struct final_awaiter {
+      bool await_ready() noexcept { return false; }
+
+      void await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+        auto& s = *h.promise().s;
+        std::lock_guard<std::mutex> lock{s.mutex};
+        s.done = true;
+        s.cv.notify_one();
+      }
+
+      void await_resume() noexcept {}
+    };
+
+    sync_wait_driver get_return_object() noexcept {
+      return {std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    final_awaiter final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+
+    state* s{nullptr};
+  };
+
+  std::coroutine_handle<promise_type> h;
+};
+
+template <class T>
+sync_wait_driver drive(task<T>& t, std::optional<T>& out,
+                       std::exception_ptr& error) {
+  try {
+    out.emplace(co_await std::move(t));
+  } catch (...) {
+    error = std::current_exception();
+  }
+}
+
+inline sync_wait_driver drive(task<void>& t, std::optional<bool>& out,
+                              std::exception_ptr& error) {
+  try {
+    co_await std::move(t);
+    out.emplace(true);
+  } catch (...) {
+    error = std::current_exception();
+  }
+}
+
+}  // namespace detail
+
+/**
+ * Runs @p t and blocks the calling thread until it's done, for code that isn't
+ * a coroutine itself (like main, or a test)
+ */
+template <class T>
+T sync_wait(task<T> t) {
+  using value_t = std::conditional_t<std::is_void_v<T>, bool, T>;
+  std::optional<value_t> out;
+  std::exception_ptr error;
+  detail::sync_wait_driver::state s;
+
+  auto driver = detail::drive(t, out, error);
+  driver.h.promise().s = &s;
+  driver.h.resume();
+  {
+    std::unique_lock<std::mutex> lock{s.mutex};
+    s.cv.wait(lock, [&s]() { return s.done; });
+  }
+  driver.h.destroy();
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  if constexpr (!std::is_void_v<T>) {
+    return std::move(*out);
+  }
+}
+
+}  // namespace nil::async
+
+#endif  // NIL_ASYNC_COROUTINES
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_TASK_HPP_
@@ -0,0 +1,351 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_THREADPOOL_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_THREADPOOL_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <meta/enable_if.hpp>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "async/adaptive_mutex.hpp"
+#include "async/cache_line.hpp"
+#include "async/job.hpp"
+#include "async/work_stealing_deque.hpp"
+
+namespace nil::async {
+
+/**
+ * A fixed set of worker threads running callables, so services don't each
+ * build their own pool around a single shared work queue.
+ *
+ * Every worker has its own work_stealing_deque. Callables posted from inside
+ * a task go on the current worker's deque, and run newest first while the data
+ * they touch is still in cache. Callables posted from other threads go to a
+ * per-worker inbox, picked round robin per posting thread, so posters don't all
+ * contend on one lock. A worker out of work steals the oldest callable from
+ * another worker picked at random, from its deque or else its inbox.
+ *
+ * Idle workers spin briefly, then park on a condition variable. Posting only
+ * takes the parking lock if a worker is actually parked.
+ *
+ * @note a callable passed to post() that throws terminates the program, as it
+ * would on a plain std::thread. Use submit() to get the exception back
+ * @note the destructor runs everything already posted, including what those
+ * callables post, then joins the workers. Posting from other threads while
+ * it runs is undefined behaviour
+ * @note waiting on a submit() future from inside a task blocks that worker,
+ * and deadlocks if every worker does it
+ */
+class thread_pool {
+  using job = detail::job<>;
+
+  struct alignas(cache_line_size) worker {
+    work_stealing_deque<job*> deque;
+
+    adaptive_mutex inbox_mutex;
+    std::deque<job*> inbox;                   //!< guarded by inbox_mutex
+    std::atomic<std::size_t> inbox_size{0};  //!< readable without the lock
+
+    // only used by the worker itself
+    std::deque<job*> batch;  //!< the inbox is swapped into this, when empty
+    std::uint32_t seed{1};    //!< for picking victims
+    std::thread thread;
+  };
+
+ public:
+  /** default number of workers, one per hardware thread */
+  static std::size_t default_size() noexcept {
+    return std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  // constructors --------------------------------------------------------------
+
+  /**
+   * Starts @p threads workers. With @p pin_threads, worker N is pinned to the
+   * Nth CPU the process may run on (Linux only, ignored elsewhere)
+   */
+  explicit thread_pool(std::size_t threads = default_size(),
+                       bool pin_threads = false) {
+    threads = std::max<std::size_t>(threads, 1);
+    workers_.reserve(threads);
+    for (std::size_t ii{0}; ii < threads; ii++) {
+      workers_.push_back(std::make_unique<worker>());
+      workers_.back()->seed = static_cast<std::uint32_t>(ii * 2654435761u + 1);
+    }
+    for (std::size_t ii{0}; ii < threads; ii++) {
+      auto& w = *workers_[ii];
+      w.thread = std::thread{[this, &w]() { run(w); }};
+      if (pin_threads) {
+        pin(w.thread, ii);
+      }
+    }
+  }
+
+  ~thread_pool() {
+    {
+      std::lock_guard<std::mutex> lock{park_mutex_};
+      stopping_ = true;
+    }
+    park_cv_.notify_all();
+    for (auto& w : workers_) {
+      w->thread.join();
+    }
+  }
+
+  // no copying/moving ---------------------------------------------------------
+
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+  thread_pool(thread_pool&&) = delete;
+  thread_pool& operator=(thread_pool&&) = delete;
+
+  // queue work ----------------------------------------------------------------
+
+  /** queues @p f to run on one of the workers */
+  template <class F, class = if_invocable<std::decay_t<F>&>>
+  void post(F&& f) {
+    std::unique_ptr<job> j =
+        std::make_unique<detail::job_impl<std::decay_t<F>>>(std::forward<F>(f));
+    if (auto* self = current(); self && self->pool == this) {
+      self->w->deque.push(j.get());
+    } else {
+      auto& w = *workers_[poster_index() % workers_.size()];
+      std::lock_guard<adaptive_mutex> lock{w.inbox_mutex};
+      w.inbox.push_back(j.get());
+      w.inbox_size.store(w.inbox.size(), std::memory_order_relaxed);
+    }
+    j.release();  // queued, whoever runs it deletes it
+    wake_one();
+  }
+
+  /** like post, and returns a future for @p f's result */
+  template <class F, class = if_invocable<std::decay_t<F>&>>
+  auto submit(F&& f) {
+    auto [wrapper, future] = detail::package<>(std::forward<F>(f));
+    post(std::move(wrapper));
+    return std::move(future);
+  }
+
+  // state observers -----------------------------------------------------------
+
+  std::size_t size() const noexcept { return workers_.size(); }
+
+ private:
+  /** the pool and worker the calling thread belongs to, if any */
+  struct worker_id {
+    const thread_pool* pool;
+    worker* w;
+  };
+
+  static worker_id*& current() noexcept {
+    thread_local worker_id* id = nullptr;
+    return id;
+  }
+
+  /** other threads are handed out inboxes round robin, the first time */
+  static std::size_t poster_index() noexcept {
+    static std::atomic<std::size_t> next{0};
+    thread_local const std::size_t index =
+        next.fetch_add(1, std::memory_order_relaxed);
+    return index;
+  }
+
+  static void pin(std::thread& t, std::size_t index) {
+#if defined(__linux__)
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+      return;
+    }
+    const auto count = static_cast<std::size_t>(CPU_COUNT(&allowed));
+    if (count == 0) {
+      return;
+    }
+    auto nth = index % count;
+    for (int cpu{0}; cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, &allowed) && nth-- == 0) {
+        cpu_set_t one;
+        CPU_ZERO(&one);
+        CPU_SET(cpu, &one);
+        pthread_setaffinity_np(t.native_handle(), sizeof(one), &one);
+        return;
+      }
+    }
+#else
+    (void)t;
+    (void)index;
+#endif
+  }
+
+  /** the worker loop, returns once stopping and out of work */
+  void run(worker& self) {
+    worker_id id{this, &self};
+    current() = &id;
+    for (;;) {
+      if (auto* j = find_work(self)) {
+        std::unique_ptr<job> owned{j};
+        owned->run();
+        continue;
+      }
+      if (!park()) {
+        break;
+      }
+    }
+    current() = nullptr;
+  }
+
+  /** own deque first, then own inbox, then steal, spinning briefly */
+  job* find_work(worker& self) {
+    if (auto j = self.deque.pop()) {
+      return *j;
+    }
+    if (!self.batch.empty()) {
+      auto* j = self.batch.front();  // left over, see take_inbox
+      self.batch.pop_front();
+      return j;
+    }
+    if (auto* j = take_inbox(self)) {
+      return j;
+    }
+    for (int round{0}; round < steal_rounds; round++) {
+      if (auto* j = steal(self)) {
+        return j;
+      }
+      std::this_thread::yield();
+    }
+    return nullptr;
+  }
+
+  /** moves the inbox into the deque, and returns the oldest */
+  job* take_inbox(worker& self) {
+    if (self.inbox_size.load(std::memory_order_relaxed) == 0) {
+      return nullptr;
+    }
+    auto& batch = self.batch;
+    {
+      std::lock_guard<adaptive_mutex> lock{self.inbox_mutex};
+      batch.swap(self.inbox);  // the inbox gets the old, empty batch
+      self.inbox_size.store(0, std::memory_order_relaxed);
+    }
+    if (batch.empty()) {
+      return nullptr;
+    }
+    // newest at the bottom, so the oldest are the first to be stolen
+    auto* first = batch.front();
+    batch.pop_front();
+    const bool more = !batch.empty();
+    try {
+      for (; !batch.empty(); batch.pop_front()) {
+        self.deque.push(batch.front());
+      }
+    } catch (const std::bad_alloc&) {
+      // the deque couldn't grow, so find_work runs the rest from the batch
+    }
+    if (more) {
+      wake_one();  // someone else can help with the rest
+    }
+    return first;
+  }
+
+  /** tries every other worker once, starting from a random one */
+  job* steal(worker& self) {
+    const auto n = workers_.size();
+    self.seed ^= self.seed << 13;
+    self.seed ^= self.seed >> 17;
+    self.seed ^= self.seed << 5;
+    const auto start = self.seed % n;
+    for (std::size_t ii{0}; ii < n; ii++) {
+      auto& victim = *workers_[(start + ii) % n];
+      if (&victim == &self) {
+        continue;
+      }
+      if (auto j = victim.deque.steal()) {
+        return *j;
+      }
+      if (victim.inbox_size.load(std::memory_order_relaxed) == 0) {
+        continue;
+      }
+      std::unique_lock<adaptive_mutex> lock{victim.inbox_mutex,
+                                            std::try_to_lock};
+      if (lock && !victim.inbox.empty()) {
+        auto* j = victim.inbox.front();
+        victim.inbox.pop_front();
+        victim.inbox_size.store(victim.inbox.size(),
+                                std::memory_order_relaxed);
+        return j;
+      }
+    }
+    return nullptr;
+  }
+
+  /** whether any deque or inbox has work, a snapshot */
+  bool has_work() const noexcept {
+    return std::any_of(workers_.cbegin(), workers_.cend(), [](const auto& w) {
+      return !w->deque.empty() ||
+             w->inbox_size.load(std::memory_order_relaxed) > 0;
+    });
+  }
+
+  /**
+   * Sleeps until work is posted. Returns false if the pool is stopping and
+   * there's no work left. The seq_cst fence pairs with the one in wake_one, so
+   * either the poster sees us parked or we see its work
+   */
+  bool park() {
+    std::unique_lock<std::mutex> lock{park_mutex_};
+    sleepers_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const auto epoch = epoch_;
+    bool keep_going = true;
+    if (!has_work()) {
+      if (stopping_) {
+        keep_going = false;
+      } else {
+        park_cv_.wait(lock,
+                      [this, epoch]() { return epoch_ != epoch || stopping_; });
+      }
+    }
+    sleepers_.fetch_sub(1, std::memory_order_relaxed);
+    return keep_going;
+  }
+
+  /** wakes a parked worker, if there is one */
+  void wake_one() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_relaxed) == 0) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock{park_mutex_};
+      epoch_++;
+    }
+    park_cv_.notify_one();
+  }
+
+  static constexpr int steal_rounds = 4;  //!< before parking
+
+  std::vector<std::unique_ptr<worker>> workers_;
+
+  alignas(cache_line_size) std::atomic<std::size_t> sleepers_{0};
+  std::mutex park_mutex_;
+  std::condition_variable park_cv_;
+  std::uint64_t epoch_{0};  //!< guarded by park_mutex_, bumped by wake_one
+  bool stopping_{false};    //!< guarded by park_mutex_
+};
+
+}  // namespace nil::async
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_THREADPOOL_HPP_
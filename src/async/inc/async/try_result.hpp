@@ -0,0 +1,42 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_TRYRESULT_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_TRYRESULT_HPP_
+
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace nil::async {
+
+/**
+ * What the try_apply functions return for a function returning @tparam R:
+ * whether it ran if R is void, otherwise a copy of its result, or nullopt if
+ * the lock couldn't be taken
+ */
+template <class R>
+using try_result_t = std::conditional_t<std::is_void_v<R>, bool,
+                                        std::optional<std::decay_t<R>>>;
+
+namespace detail {
+
+/** invokes @p f with @p args only if @p lock got hold of its mutex */
+template <class Lock, class F, class... Args>
+try_result_t<std::invoke_result_t<F, Args...>> invoke_if_owned(
+    const Lock& lock, F&& f, Args&&... args) {
+  using result_t = std::invoke_result_t<F, Args...>;
+  if (!lock.owns_lock()) {
+    return try_result_t<result_t>{};
+  }
+  if constexpr (std::is_void_v<result_t>) {
+    std::invoke(std::forward<F>(f), std::forward<Args>(args)...);
+    return true;
+  } else {
+    return std::invoke(std::forward<F>(f), std::forward<Args>(args)...);
+  }
+}
+
+}  // namespace detail
+
+}  // namespace nil::async
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_TRYRESULT_HPP_
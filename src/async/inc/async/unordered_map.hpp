@@ -0,0 +1,22 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_UNORDEREDMAP_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_UNORDEREDMAP_HPP_
+
+#include <mutex>
+#include <unordered_map>
+
+#include "async/unordered_map_base.hpp"
+
+namespace nil::async {
+
+/**
+ * Partially specified alias when using unordered_map_base with
+ * std::unordered_map, std::mutex and std::lock_guard. Prefer this over
+ * unordered_map_base for hash maps
+ */
+template <class K, class V, class... Params>
+using unordered_map = unordered_map_base<std::unordered_map<K, V, Params...>,
+                                         std::mutex, std::lock_guard>;
+
+}  // namespace nil::async
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_UNORDEREDMAP_HPP_
@@ -0,0 +1,269 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_UNORDEREDMAPBASE_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_UNORDEREDMAPBASE_HPP_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <meta/enable_if.hpp>
+#include <optional>
+#include <string>
+
+#include "async/cache_line.hpp"
+#include "async/container_traits.hpp"
+
+namespace nil::async {
+
+/**
+ * Wraps an STL-like hash map, split into a number of independently locked
+ * shards. Each key always lives in the same shard, so operations on keys in
+ * different shards never contend on the same mutex, unlike a single map
+ * wrapped in nil::atomic.
+ *
+ * Like container_base, nothing returns references or iterators into the map.
+ * find returns a copy, and `apply(key, f)` runs @p f on one value while only
+ * that value's shard is locked.
+ *
+ * @note operations spanning the whole map (size, clear, for_each) lock one
+ * shard at a time, so they are not a consistent snapshot if other threads are
+ * writing concurrently
+ *
+ * @tparam Map - a fully templated STL-like map, such as
+ * std::unordered_map<std::string, int>
+ * @tparam Mutex - a standard mutex type, like std::mutex
+ * @tparam LockGuard - an RAII lock type, like std::lock_guard
+ */
+template <class Map, class Mutex, template <class> class LockGuard>
+class unordered_map_base {
+  static_assert(is_map_like_v<Map>,
+                "unordered_map_base needs an STL-like map, with find, "
+                "insert_or_assign, erase by key, size, empty and clear");
+
+ public:
+  using map_type = Map;
+  using key_type = typename map_type::key_type;
+  using mapped_type = typename map_type::mapped_type;
+  using value_type = typename map_type::value_type;
+  using size_type = typename map_type::size_type;
+  using hasher = typename map_type::hasher;
+  using mutex_type = Mutex;
+  using lock_type_t = LockGuard<Mutex>;
+
+  static constexpr size_type default_shard_count = 16;
+
+  // constructors --------------------------------------------------------------
+
+  /** @param shard_count - rounded up to the next power of two */
+  explicit unordered_map_base(size_type shard_count = default_shard_count)
+      : shift_{shift_for(shard_count)},
+        count_{size_type{1} << (64 - shift_)},
+        shards_{std::make_unique<shard[]>(count_)} {}
+
+  // Copy / Move ---------------------------------------------------------------
+
+  unordered_map_base(const unordered_map_base&) = delete;
+  unordered_map_base& operator=(const unordered_map_base&) = delete;
+  unordered_map_base(unordered_map_base&&) = delete;
+  unordered_map_base& operator=(unordered_map_base&&) = delete;
+
+  // Access --------------------------------------------------------------------
+
+  std::optional<mapped_type> find(const key_type& key) const {
+    const auto& s = shard_for(key);
+    lock_type_t lock{s.mutex};
+    const auto it = s.map.find(key);
+    if (it == s.map.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+
+  bool contains(const key_type& key) const {
+    const auto& s = shard_for(key);
+    lock_type_t lock{s.mutex};
+    return s.map.find(key) != s.map.end();
+  }
+
+  // Insertion -----------------------------------------------------------------
+
+  /** returns false, leaving the existing value untouched, if @p key exists */
+  template <class K = key_type, class V = mapped_type>
+  bool insert(K&& key, V&& v) {
+    auto& s = shard_for(key);
+    lock_type_t lock{s.mutex};
+    return s.map.try_emplace(std::forward<K>(key), std::forward<V>(v)).second;
+  }
+
+  /** returns true if @p key was inserted, false if it was assigned */
+  template <class K = key_type, class V = mapped_type>
+  bool insert_or_assign(K&& key, V&& v) {
+    auto& s = shard_for(key);
+    lock_type_t lock{s.mutex};
+    return s.map.insert_or_assign(std::forward<K>(key), std::forward<V>(v))
+        .second;
+  }
+
+  // Remove --------------------------------------------------------------------
+
+  /** returns the number of elements removed, 0 or 1 */
+  size_type erase(const key_type& key) {
+    auto& s = shard_for(key);
+    lock_type_t lock{s.mutex};
+    return s.map.erase(key);
+  }
+
+  std::optional<mapped_type> extract(const key_type& key) {
+    auto& s = shard_for(key);
+    lock_type_t lock{s.mutex};
+    auto node = s.map.extract(key);
+    if (node.empty()) {
+      return std::nullopt;
+    }
+    return std::move(node.mapped());
+  }
+
+  void clear() {
+    for (size_type ii{0}; ii < shard_count(); ii++) {
+      lock_type_t lock{shards_[ii].mutex};
+      shards_[ii].map.clear();
+    }
+  }
+
+  // arbitrary function --------------------------------------------------------
+
+  /**
+   * Invokes @p f on the value for @p key, default constructing it first if it
+   * doesn't exist yet (like operator[]). Only @p key's shard is locked
+   */
+  template <class F, class = if_invocable<F, mapped_type&>>
+  auto apply(const key_type& key, F&& f) {
+    auto& s = shard_for(key);
+    lock_type_t lock{s.mutex};
+    return std::invoke(std::forward<F>(f), s.map[key]);
+  }
+
+  /** invokes @p f on the value for @p key, if it exists */
+  template <class F, class = if_invocable<F, const mapped_type&>>
+  bool apply_if(const key_type& key, F&& f) const {
+    const auto& s = shard_for(key);
+    lock_type_t lock{s.mutex};
+    const auto it = s.map.find(key);
+    if (it == s.map.end()) {
+      return false;
+    }
+    std::invoke(std::forward<F>(f),
+                static_cast<const mapped_type&>(it->second));
+    return true;
+  }
+
+  /** invokes @p f on the value for @p key, if it exists */
+  template <class F,
+            class = If<std::is_invocable_v<F, mapped_type&> &&
+                       not std::is_invocable_v<F, const mapped_type&>>>
+  bool apply_if(const key_type& key, F&& f) {
+    auto& s = shard_for(key);
+    lock_type_t lock{s.mutex};
+    const auto it = s.map.find(key);
+    if (it == s.map.end()) {
+      return false;
+    }
+    std::invoke(std::forward<F>(f), it->second);
+    return true;
+  }
+
+  /** invokes @p f with every key and value, locking one shard at a time */
+  template <class F,
+            class = if_invocable<F, const key_type&, const mapped_type&>>
+  void for_each(F&& f) const {
+    for (size_type ii{0}; ii < shard_count(); ii++) {
+      const auto& s = shards_[ii];
+      lock_type_t lock{s.mutex};
+      for (const auto& [key, value] : s.map) {
+        std::invoke(f, key, value);
+      }
+    }
+  }
+
+  /** invokes @p f with every key and value, locking one shard at a time */
+  template <class F,
+            class = If<std::is_invocable_v<F, const key_type&, mapped_type&> &&
+                       not std::is_invocable_v<F, const key_type&,
+                                               const mapped_type&>>>
+  void for_each(F&& f) {
+    for (size_type ii{0}; ii < shard_count(); ii++) {
+      auto& s = shards_[ii];
+      lock_type_t lock{s.mutex};
+      for (auto& [key, value] : s.map) {
+        std::invoke(f, key, value);
+      }
+    }
+  }
+
+  // state observers -----------------------------------------------------------
+
+  size_type shard_count() const noexcept { return count_; }
+
+  /** sums the shards one at a time, only a snapshot if others are writing */
+  size_type size() const noexcept {
+    size_type total{0};
+    for (size_type ii{0}; ii < shard_count(); ii++) {
+      lock_type_t lock{shards_[ii].mutex};
+      total += shards_[ii].map.size();
+    }
+    return total;
+  }
+
+  bool empty() const noexcept { return size() == 0; }
+
+  // instrumentation -----------------------------------------------------------
+
+  /**
+   * Names every shard's lock in the lock_registry, so they're reported
+   * together. Only compiles if the mutex supports it, like instrumented_mutex
+   */
+  void set_lock_name(const std::string& name) {
+    for (size_type ii{0}; ii < shard_count(); ii++) {
+      shards_[ii].mutex.set_name(name);
+    }
+  }
+
+ private:
+  /** one lock and its map, on their own cache line(s) */
+  struct alignas(cache_line_size) shard {
+    mutable mutex_type mutex;
+    map_type map;
+  };
+
+  /** right shift that maps a 64-bit hash onto the (power of two) shards */
+  static unsigned shift_for(size_type shard_count) {
+    unsigned shift = 64;
+    while (shift > 1 && (std::uint64_t{1} << (64 - shift)) < shard_count) {
+      shift--;
+    }
+    return shift;
+  }
+
+  /**
+   * Fibonacci hashing on top of the map's own hasher. std::hash is often the
+   * identity, so taking its top bits after a multiply keeps the shards from
+   * correlating with the buckets inside each map.
+   */
+  size_type index_for(const key_type& key) const {
+    const auto h = static_cast<std::uint64_t>(hasher{}(key));
+    const auto mixed = h * std::uint64_t{0x9E3779B97F4A7C15};
+    return shift_ == 64 ? 0 : static_cast<size_type>(mixed >> shift_);
+  }
+
+  shard& shard_for(const key_type& key) { return shards_[index_for(key)]; }
+
+  const shard& shard_for(const key_type& key) const {
+    return shards_[index_for(key)];
+  }
+
+  const unsigned shift_;
+  const size_type count_;
+  const std::unique_ptr<shard[]> shards_;
+};
+
+}  // namespace nil::async
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_UNORDEREDMAPBASE_HPP_
@@ -0,0 +1,178 @@
+#ifndef NIL_SRC_ASYNC_INC_ASYNC_WORKSTEALINGDEQUE_HPP_
+#define NIL_SRC_ASYNC_INC_ASYNC_WORKSTEALINGDEQUE_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "async/cache_line.hpp"
+
+namespace nil::async {
+
+/**
+ * Lock-free work-stealing deque, the per-worker queue of thread_pool. One
+ * owner thread pushes and pops at the bottom, like a stack, and any number of
+ * other threads steal from the top, taking the oldest element.
+ *
+ * Based on the Chase-Lev deque, with the memory orderings of Le et al.
+ * "Correct and Efficient Work-Stealing for Weak Memory Models". The owner only
+ * contends with thieves over the last element, so push and pop are a few plain
+ * loads and stores otherwise. Top and bottom live on separate cache lines.
+ *
+ * The ring grows when full. Older rings are kept until the deque is destroyed,
+ * since a thief may still be reading one, so memory is at most twice the
+ * largest size reached.
+ *
+ * @note push and pop must only be called by the owner thread. steal, size and
+ * empty may be called by anyone
+ *
+ * @tparam T - a trivially copyable type, usually a pointer to the work item
+ */
+template <class T>
+class work_stealing_deque {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "T must be trivially copyable");
+
+  using index_t = std::int64_t;
+
+  /** a power of two sized circular array */
+  struct ring {
+    explicit ring(index_t capacity)
+        : mask{capacity - 1},
+          slots{std::make_unique<std::atomic<T>[]>(capacity)} {}
+
+    index_t capacity() const noexcept { return mask + 1; }
+
+    T get(index_t ii) const noexcept {
+      return slots[ii & mask].load(std::memory_order_relaxed);
+    }
+
+    void put(index_t ii, T t) noexcept {
+      slots[ii & mask].store(t, std::memory_order_relaxed);
+    }
+
+    index_t mask;
+    std::unique_ptr<std::atomic<T>[]> slots;
+  };
+
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+
+  // constructors --------------------------------------------------------------
+
+  /** @param capacity - initial size, rounded up to the next power of two */
+  explicit work_stealing_deque(size_type capacity = 64) {
+    rings_.push_back(std::make_unique<ring>(round_up(capacity)));
+    ring_.store(rings_.back().get(), std::memory_order_relaxed);
+  }
+
+  // no copying/moving ---------------------------------------------------------
+
+  work_stealing_deque(const work_stealing_deque&) = delete;
+  work_stealing_deque& operator=(const work_stealing_deque&) = delete;
+  work_stealing_deque(work_stealing_deque&&) = delete;
+  work_stealing_deque& operator=(work_stealing_deque&&) = delete;
+
+  // owner only ----------------------------------------------------------------
+
+  /** adds @p t at the bottom, growing the ring if it's full */
+  void push(T t) {
+    const auto b = bottom_.load(std::memory_order_relaxed);
+    const auto top = top_.load(std::memory_order_acquire);
+    auto* r = ring_.load(std::memory_order_relaxed);
+    if (b - top >= r->capacity()) {
+      r = grow(r, top, b);
+    }
+    r->put(b, t);
+    bottom_.store(b + 1, std::memory_order_release);
+  }
+
+  /** takes the newest element, or nullopt if empty */
+  std::optional<T> pop() noexcept {
+    const auto b = bottom_.load(std::memory_order_relaxed) - 1;
+    auto* r = ring_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto top = top_.load(std::memory_order_relaxed);
+
+    if (top > b) {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return std::nullopt;
+    }
+    std::optional<T> t{r->get(b)};
+    if (top == b) {
+      // the last element, race any thieves for it
+      if (!top_.compare_exchange_strong(top, top + 1,
+                                        std::memory_order_seq_cst,
+                                        std::memory_order_relaxed)) {
+        t.reset();
+      }
+      bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+    return t;
+  }
+
+  // any thread ----------------------------------------------------------------
+
+  /**
+   * Takes the oldest element. Returns nullopt if empty, or if another thread
+   * took it first
+   */
+  std::optional<T> steal() noexcept {
+    auto top = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const auto b = bottom_.load(std::memory_order_acquire);
+    if (top >= b) {
+      return std::nullopt;
+    }
+    const auto t = ring_.load(std::memory_order_acquire)->get(top);
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return std::nullopt;
+    }
+    return t;
+  }
+
+  /** only a snapshot, unless called by the owner with no thieves around */
+  size_type size() const noexcept {
+    const auto b = bottom_.load(std::memory_order_relaxed);
+    const auto top = top_.load(std::memory_order_relaxed);
+    return b > top ? static_cast<size_type>(b - top) : 0;
+  }
+
+  bool empty() const noexcept { return size() == 0; }
+
+ private:
+  static index_t round_up(size_type n) {
+    index_t pow2 = 2;
+    while (static_cast<size_type>(pow2) < n) {
+      pow2 <<= 1;
+    }
+    return pow2;
+  }
+
+  /** copies [top, bottom) into a ring twice the size, and publishes it */
+  ring* grow(ring* old, index_t top, index_t bottom) {
+    auto bigger = std::make_unique<ring>(old->capacity() * 2);
+    for (auto ii = top; ii < bottom; ii++) {
+      bigger->put(ii, old->get(ii));
+    }
+    rings_.push_back(std::move(bigger));
+    auto* r = rings_.back().get();
+    ring_.store(r, std::memory_order_release);
+    return r;
+  }
+
+  alignas(cache_line_size) std::atomic<index_t> top_{0};
+  alignas(cache_line_size) std::atomic<index_t> bottom_{0};
+  std::atomic<ring*> ring_{nullptr};
+  std::vector<std::unique_ptr<ring>> rings_;  //!< owner only, oldest first
+};
+
+}  // namespace nil::async
+
+#endif  // NIL_SRC_ASYNC_INC_ASYNC_WORKSTEALINGDEQUE_HPP_
@@ -0,0 +1,92 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE adaptive_mutex_test
+
+#include "async/adaptive_mutex.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <future>
+#include <thread>
+
+#include "async/spin_atomic.hpp"
+#include "async/spin_deque.hpp"
+#include "async/spin_optional.hpp"
+#include "async/spin_vector.hpp"
+
+using namespace nil;
+using namespace nil::async;
+
+BOOST_AUTO_TEST_CASE(TryLockTest) {
+  adaptive_mutex mutex;
+  BOOST_CHECK(mutex.try_lock());
+  BOOST_CHECK(!mutex.try_lock());
+  mutex.unlock();
+
+  {
+    std::lock_guard<adaptive_mutex> lock{mutex};
+    BOOST_CHECK(!mutex.try_lock());
+  }
+  BOOST_CHECK(mutex.try_lock());
+  mutex.unlock();
+}
+
+BOOST_AUTO_TEST_CASE(ParkTest) {
+  adaptive_mutex mutex;
+  std::unique_lock<adaptive_mutex> lock{mutex};
+
+  // long enough for the other thread to use up its spins and park
+  auto f = std::async(std::launch::async, [&mutex]() {
+    std::lock_guard<adaptive_mutex> inner{mutex};
+    return true;
+  });
+  BOOST_CHECK(f.wait_for(std::chrono::milliseconds(50)) ==
+              std::future_status::timeout);
+
+  lock.unlock();
+  BOOST_CHECK(f.get());
+}
+
+BOOST_AUTO_TEST_CASE(MutualExclusionTest) {
+  adaptive_mutex mutex;
+  long counter{0};  // deliberately not atomic
+  const int per_thread = 100000;
+
+  auto func = [&]() {
+    for (int ii{0}; ii < per_thread; ii++) {
+      std::lock_guard<adaptive_mutex> lock{mutex};
+      counter++;
+    }
+  };
+
+  std::vector<std::future<void>> futures;
+  for (int tt{0}; tt < 4; tt++) {
+    futures.push_back(std::async(std::launch::async, func));
+  }
+  for (auto& f : futures) {
+    f.get();
+  }
+  BOOST_CHECK_EQUAL(counter, 4L * per_thread);
+}
+
+BOOST_AUTO_TEST_CASE(AliasTest) {
+  spin_atomic<std::string> str{"hello"};
+  str.push("yo");
+  BOOST_CHECK_EQUAL(str.peek(), "yo");
+
+  spin_optional<int> opt;
+  BOOST_CHECK(!opt.peek());
+  opt.push(3);
+  BOOST_CHECK_EQUAL(opt.pop().value(), 3);
+
+  spin_vector<int> vec;
+  vec.push_back(1);
+  BOOST_CHECK_EQUAL(vec.at(0).value(), 1);
+
+  // container_base waits on a condition_variable_any for non-std mutexes
+  spin_deque<int> deque;
+  auto f = std::async(std::launch::async,
+                      [&deque]() { return deque.wait_extract_front(); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  deque.push_back(5);
+  BOOST_CHECK_EQUAL(f.get(), 5);
+}
@@ -0,0 +1,146 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE apply_all_test
+
+#include "async/apply_all.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <future>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "async/atomic.hpp"
+#include "async/atomic_rw.hpp"
+#include "async/deque.hpp"
+#include "async/optional.hpp"
+#include "async/vector.hpp"
+
+using namespace nil;
+using namespace std::chrono_literals;
+
+BOOST_AUTO_TEST_CASE(BasicTest) {
+  nil::atomic<int> from{100};
+  nil::atomic<int> to{0};
+  async::vector<std::string> log;
+
+  const auto moved = apply_all(
+      [](int& f, int& t, auto& l) {
+        f -= 30;
+        t += 30;
+        l.push_back("moved 30");
+        return 30;
+      },
+      from, to, log);
+
+  BOOST_CHECK_EQUAL(moved, 30);
+  BOOST_CHECK_EQUAL(from.peek(), 70);
+  BOOST_CHECK_EQUAL(to.peek(), 30);
+  BOOST_CHECK_EQUAL(log.back().value(), "moved 30");
+
+  // a single wrapper works too, and so do void functions
+  apply_all([](int& f) { f = 0; }, from);
+  BOOST_CHECK_EQUAL(from.peek(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(MixedTypesTest) {
+  nil::atomic<std::string> name{"name"};
+  nil::atomic_rw<std::set<int>> ids{1, 2};
+  async::optional<int> last;
+
+  apply_all(
+      [](const std::string& n, std::set<int>& i, std::optional<int>& l) {
+        i.insert(static_cast<int>(n.size()));
+        l = *i.rbegin();
+      },
+      std::as_const(name), ids, last);
+
+  BOOST_CHECK(ids.copy() == (std::set<int>{1, 2, 4}));
+  BOOST_CHECK_EQUAL(last.peek().value(), 4);
+}
+
+BOOST_AUTO_TEST_CASE(SharedLockTest) {
+  nil::atomic_rw<std::set<int>> ids{1, 2};
+  nil::atomic<int> total{0};
+
+  // a const atomic_rw only takes the shared lock, so readers get through
+  apply_all(
+      [&ids](const auto& i, int& t) {
+        t = static_cast<int>(i.size());
+        auto reader =
+            std::async(std::launch::async, [&ids]() { return ids->size(); });
+        BOOST_REQUIRE(reader.wait_for(5s) == std::future_status::ready);
+        BOOST_CHECK_EQUAL(reader.get(), 2u);
+      },
+      std::as_const(ids), total);
+  BOOST_CHECK_EQUAL(total.peek(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(ChangeTest) {
+  nil::atomic<int> a{0};
+  nil::atomic_rw<int> rw{0};
+  async::deque<int> q;
+
+  // non-const wrappers count as changed
+  const auto a_version = a.version();
+  const auto rw_version = rw.version();
+  apply_all([](auto&, auto&) {}, a, rw);
+  BOOST_CHECK_NE(a.version(), a_version);
+  BOOST_CHECK_NE(rw.version(), rw_version);
+
+  // const ones don't
+  apply_all([](const auto&, const auto&) {}, std::as_const(a),
+            std::as_const(rw));
+  BOOST_CHECK(!a.peek_if_newer(a.version()));
+  BOOST_CHECK(!rw.copy_if_newer(rw.version()));
+
+  // and waiters wake up
+  auto waiter = std::async(std::launch::async, [&a]() {
+    a.wait_until([](int v) { return v == 1; });
+  });
+  auto consumer =
+      std::async(std::launch::async, [&q]() { return q.wait_extract_front(); });
+  BOOST_CHECK(waiter.wait_for(20ms) == std::future_status::timeout);
+
+  apply_all(
+      [](int& v, auto& elems) {
+        v = 1;
+        elems.push_back(5);
+      },
+      a, q);
+  BOOST_REQUIRE(waiter.wait_for(5s) == std::future_status::ready);
+  BOOST_REQUIRE(consumer.wait_for(5s) == std::future_status::ready);
+  BOOST_CHECK_EQUAL(consumer.get(), 5);
+}
+
+BOOST_AUTO_TEST_CASE(NoDeadlockTest) {
+  nil::atomic<int> a{1000};
+  nil::atomic<int> b{1000};
+  nil::atomic_rw<int> c{1000};
+  const int count = 10000;
+
+  // every thread locks the same objects in a different order
+  auto f1 = std::async(std::launch::async, [&]() {
+    for (int ii{0}; ii < count; ii++) {
+      apply_all([](int& x, int& y, int&) { x--, y++; }, a, b, c);
+    }
+  });
+  auto f2 = std::async(std::launch::async, [&]() {
+    for (int ii{0}; ii < count; ii++) {
+      apply_all([](int&, int& y, int& x) { x--, y++; }, c, b, a);
+    }
+  });
+  auto f3 = std::async(std::launch::async, [&]() {
+    for (int ii{0}; ii < count; ii++) {
+      apply_all([](int& x, const int&, int& y) { x--, y++; }, c,
+                std::as_const(a), b);
+    }
+  });
+  f1.get();
+  f2.get();
+  f3.get();
+
+  BOOST_CHECK_EQUAL(a.peek() + b.peek() + c.copy(), 3000);
+  BOOST_CHECK_EQUAL(b.peek(), 1000 + 3 * count);
+}
@@ -0,0 +1,211 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE async_mutex_test
+
+#include "async/async_mutex.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "async/apply_all.hpp"
+#include "async/atomic_base.hpp"
+#include "async/container_base.hpp"
+#include "async/optional_base.hpp"
+#include "async/task.hpp"
+
+using namespace nil;
+using namespace nil::async;
+
+template <class T>
+using async_atomic = atomic_base<T, async_mutex, std::lock_guard>;
+
+template <class T>
+using async_optional = optional_base<T, std::optional, std::nullopt_t,
+                                     async_mutex, std::lock_guard>;
+
+template <class T>
+using async_deque =
+    container_base<std::deque<T>, async_mutex, std::lock_guard>;
+
+namespace {
+
+/** starts straight away and cleans up after itself, for fire and forget */
+struct detached {
+  struct promise_type {
+    detached get_return_object() noexcept { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+};
+
+detached append(async_atomic<std::vector<int>>* v, int ii) {
+  co_await v->apply_async([ii](std::vector<int>& vec) { vec.push_back(ii); });
+}
+
+detached consume(async_deque<int>* q, std::vector<int>* out) {
+  out->push_back(co_await q->wait_extract_front_async());
+}
+
+task<int> add_twice(async_atomic<int>& value, int n) {
+  co_await value.apply_async([n](int& v) { v += n; });
+  co_return co_await value.apply_async([n](int& v) { return v += n; });
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(LockTest) {
+  async_mutex mutex;
+  sync_wait([](async_mutex& m) -> task<> {
+    co_await m.lock_async();
+    std::lock_guard<async_mutex> lock{m, std::adopt_lock};
+    BOOST_CHECK(!m.try_lock());
+  }(mutex));
+
+  // Lockable, for plain threads
+  BOOST_CHECK(mutex.try_lock());
+  mutex.unlock();
+  std::lock_guard<async_mutex> lock{mutex};
+  BOOST_CHECK(!mutex.try_lock());
+}
+
+BOOST_AUTO_TEST_CASE(ApplyAsyncTest) {
+  async_atomic<int> value{1};
+  BOOST_CHECK_EQUAL(sync_wait(add_twice(value, 2)), 5);
+
+  const auto& const_value = value;
+  BOOST_CHECK_EQUAL(
+      sync_wait(const_value.apply_async([](const int& v) { return v * 2; })),
+      10);
+  sync_wait(value.apply_async([](int& v) { v = 0; }));
+  BOOST_CHECK_EQUAL(value.peek(), 0);
+
+  async_optional<std::string> opt;
+  sync_wait(opt.apply_async([](std::optional<std::string>& o) { o = "hi"; }));
+  BOOST_CHECK(opt.peek() == std::optional<std::string>{"hi"});
+
+  async_deque<int> queue;
+  queue.push_back(1);
+  BOOST_CHECK_EQUAL(sync_wait(queue.apply_async([](std::deque<int>& q) {
+                      q.push_back(2);
+                      return q.size();
+                    })),
+                    2u);
+}
+
+BOOST_AUTO_TEST_CASE(ExceptionTest) {
+  async_atomic<int> value{1};
+  BOOST_CHECK_THROW(sync_wait(value.apply_async([](int&) -> int {
+                      throw std::runtime_error("oops");
+                    })),
+                    std::runtime_error);
+
+  // the lock was released on the way out
+  BOOST_CHECK_EQUAL(sync_wait(value.apply_async([](int& v) { return ++v; })),
+                    2);
+}
+
+BOOST_AUTO_TEST_CASE(SuspendTest) {
+  async_atomic<std::vector<int>> values;
+  const int count = 100000;
+
+  // while the lock is held, every coroutine suspends and the thread carries on
+  values.apply([&values](std::vector<int>&) {
+    for (int ii{0}; ii < count; ii++) {
+      append(&values, ii);
+    }
+  });
+
+  // they ran in order when it was released, without growing the stack
+  const auto result = values.peek();
+  BOOST_REQUIRE_EQUAL(result.size(), std::size_t{count});
+  for (int ii{0}; ii < count; ii++) {
+    BOOST_REQUIRE_EQUAL(result[ii], ii);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(WaitExtractAsyncTest) {
+  async_deque<int> queue;
+  std::vector<int> out;
+
+  consume(&queue, &out);
+  consume(&queue, &out);
+  BOOST_CHECK(out.empty());
+
+  // each push resumes one waiter, in the order they started waiting
+  queue.push_back(1);
+  BOOST_CHECK(out == std::vector<int>{1});
+  queue.apply([](std::deque<int>& q) { q.push_back(2); });
+  BOOST_CHECK((out == std::vector<int>{1, 2}));
+
+  // doesn't suspend if there's an element already
+  queue.push_back(3);
+  BOOST_CHECK_EQUAL(sync_wait(queue.wait_extract_back_async()), 3);
+  BOOST_CHECK(queue.empty());
+}
+
+BOOST_AUTO_TEST_CASE(ApplyAllTest) {
+  async_deque<int> queue;
+  async_atomic<int> pushed{0};
+  std::vector<int> out;
+
+  consume(&queue, &out);
+  consume(&queue, &out);
+
+  // pushing through apply_all resumes waiting coroutines too
+  apply_all(
+      [](std::deque<int>& q, int& count) {
+        q.push_back(1);
+        q.push_back(2);
+        count += 2;
+      },
+      queue, pushed);
+  BOOST_CHECK((out == std::vector<int>{1, 2}));
+  BOOST_CHECK(queue.empty());
+  BOOST_CHECK_EQUAL(pushed.peek(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(MultithreadedTest) {
+  async_atomic<long> counter{0};
+  async_deque<int> queue;
+  const int per_thread = 5000;
+  const int threads = 4;
+
+  // coroutines and plain threads take turns on the same mutex
+  std::vector<std::future<void>> futures;
+  for (int tt{0}; tt < threads; tt++) {
+    futures.push_back(std::async(std::launch::async, [&]() {
+      for (int ii{0}; ii < per_thread; ii++) {
+        sync_wait(counter.apply_async([](long& c) { c++; }));
+        counter.apply([](long& c) { c++; });
+        queue.push_back(ii);
+      }
+    }));
+  }
+
+  auto consumer = std::async(std::launch::async, [&queue]() {
+    return sync_wait([](async_deque<int>& q) -> task<long> {
+      long total{0};
+      for (int ii{0}; ii < per_thread * threads; ii++) {
+        total += co_await q.wait_extract_front_async();
+      }
+      co_return total;
+    }(queue));
+  });
+
+  for (auto& f : futures) {
+    f.get();
+  }
+  BOOST_CHECK_EQUAL(counter.peek(), 2L * threads * per_thread);
+  BOOST_CHECK_EQUAL(consumer.get(),
+                    long{threads} * per_thread * (per_thread - 1) / 2);
+  BOOST_CHECK(queue.empty());
+}
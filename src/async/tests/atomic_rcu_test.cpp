@@ -0,0 +1,156 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE atomic_rcu_test
+
+#include "async/atomic_rcu.hpp"
+
+#include <atomic>
+#include <boost/test/unit_test.hpp>
+#include <future>
+#include <memory>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+using namespace nil;
+
+BOOST_AUTO_TEST_CASE(ReadTest) {
+  atomic_rcu<std::set<int>> rcu_set{1, 4, 5, 6};
+  BOOST_CHECK(rcu_set.copy() == (std::set<int>{1, 4, 5, 6}));
+  rcu_set.assign(4, 6, 7, 9);
+  BOOST_CHECK(rcu_set.copy() == (std::set<int>{4, 6, 7, 9}));
+
+  auto snapshot = rcu_set.read();
+  BOOST_CHECK_EQUAL(snapshot->size(), 4);
+  BOOST_CHECK_EQUAL(rcu_set->count(4), 1u);
+  BOOST_CHECK_EQUAL((*rcu_set)->count(2), 0u);
+  BOOST_CHECK_EQUAL(4 + 6 + 7 + 9,
+                    std::accumulate(snapshot->cbegin(), snapshot->cend(), 0));
+}
+
+BOOST_AUTO_TEST_CASE(SnapshotIsolationTest) {
+  atomic_rcu<std::set<int>> rcu_set{1, 2, 3};
+  auto before = rcu_set.read();
+
+  {
+    auto proxy = rcu_set.write();
+    proxy->insert(4);
+    (*proxy).erase(1);
+    BOOST_CHECK_EQUAL(proxy.value().size(), 3);
+
+    // not published until the proxy is destroyed
+    BOOST_CHECK(rcu_set.copy() == (std::set<int>{1, 2, 3}));
+  }
+
+  BOOST_CHECK(rcu_set.copy() == (std::set<int>{2, 3, 4}));
+  BOOST_CHECK(*before == (std::set<int>{1, 2, 3}));
+
+  auto size = rcu_set.update([](auto& s) {
+    s.insert(10);
+    return s.size();
+  });
+  BOOST_CHECK_EQUAL(size, 4);
+  BOOST_CHECK(rcu_set.copy() == (std::set<int>{2, 3, 4, 10}));
+}
+
+BOOST_AUTO_TEST_CASE(ThrowingWriteTest) {
+  atomic_rcu<std::set<int>> rcu_set{1, 2};
+  const auto before = rcu_set.read();
+
+  // a write that throws halfway publishes nothing
+  const auto throwing = [](std::set<int>& s) {
+    s.insert(3);
+    throw std::runtime_error("oops");
+  };
+  BOOST_CHECK_THROW(rcu_set.update(throwing), std::runtime_error);
+  BOOST_CHECK_EQUAL(rcu_set.read(), before);
+
+  try {
+    auto proxy = rcu_set.write();
+    proxy->clear();
+    throw std::runtime_error("oops");
+  } catch (const std::runtime_error&) {
+  }
+  BOOST_CHECK_EQUAL(rcu_set.read(), before);
+
+  // and releases the writer lock on the way out
+  rcu_set.update([](auto& s) { s.insert(3); });
+  BOOST_CHECK(rcu_set.copy() == (std::set<int>{1, 2, 3}));
+}
+
+BOOST_AUTO_TEST_CASE(ReclaimTest) {
+  atomic_rcu<int> rcu_int{1};
+  std::weak_ptr<const int> old = rcu_int.read();
+  auto held = rcu_int.read();
+
+  rcu_int.assign(2);
+  BOOST_CHECK(!old.expired());
+  BOOST_CHECK_EQUAL(*held, 1);
+
+  held.reset();
+  BOOST_CHECK(old.expired());
+  BOOST_CHECK_EQUAL(*rcu_int.read(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(MultithreadedTest) {
+  atomic_rcu<std::vector<int>> rcu_vec;
+  const auto num_writes = 2000;
+
+  auto writer = [&]() {
+    for (int ii{0}; ii < num_writes; ii++) {
+      rcu_vec.write()->push_back(1);
+    }
+  };
+
+  auto reader = [&]() {
+    std::size_t last = 0;
+    while (last < 2 * num_writes) {
+      auto snapshot = rcu_vec.read();
+      const auto sum = std::accumulate(snapshot->cbegin(), snapshot->cend(), 0);
+      if (static_cast<std::size_t>(sum) != snapshot->size() ||
+          snapshot->size() < last) {
+        return false;
+      }
+      last = snapshot->size();
+    }
+    return true;
+  };
+
+  auto r1 = std::async(std::launch::async, reader);
+  auto r2 = std::async(std::launch::async, reader);
+  auto w1 = std::async(std::launch::async, writer);
+  auto w2 = std::async(std::launch::async, writer);
+
+  w1.get();
+  w2.get();
+  BOOST_CHECK(r1.get());
+  BOOST_CHECK(r2.get());
+  BOOST_CHECK_EQUAL(rcu_vec.read()->size(), 2 * num_writes);
+}
+
+BOOST_AUTO_TEST_CASE(ReclaimUnderReadersTest) {
+  atomic_rcu<std::vector<int>> rcu_vec{std::vector<int>(64, 1)};
+  std::weak_ptr<const std::vector<int>> first = rcu_vec.read();
+  std::atomic<bool> done{false};
+
+  // readers keep loading while every old version is replaced
+  auto reader = [&]() {
+    std::size_t loads{0};
+    while (!done.load()) {
+      loads += rcu_vec.read()->size() == 64;
+    }
+    return loads;
+  };
+  auto r1 = std::async(std::launch::async, reader);
+  auto r2 = std::async(std::launch::async, reader);
+  for (int ii{0}; ii < 1000; ii++) {
+    rcu_vec.assign(std::vector<int>(64, ii));
+  }
+  done = true;
+  r1.get();
+  r2.get();
+
+  // old versions were freed once the readers let go, not held back for later
+  BOOST_CHECK(first.expired());
+  BOOST_CHECK_EQUAL(rcu_vec.read()->front(), 999);
+}
@@ -3,20 +3,42 @@
 
 #include "async/atomic_rw.hpp"
 
+#include <boost/mpl/list.hpp>
 #include <boost/test/unit_test.hpp>
+#include <chrono>
 #include <future>
 #include <iostream>
+#include <memory>
 #include <numeric>
 #include <set>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
 
 #include "async/atomic.hpp"
+#include "async/atomic_rw_scalable.hpp"
+#include "async/distributed_shared_mutex.hpp"
+#include "async/layout.hpp"
 #include "async/vector.hpp"
 
 using namespace nil;
 using namespace nil::async;
 
-BOOST_AUTO_TEST_CASE(ReadTest) {
-  atomic_rw<std::set<int>> async_set{1, 4, 5, 6};
+using SetTypes = boost::mpl::list<atomic_rw<std::set<int>>,
+                                  atomic_rw_scalable<std::set<int>>>;
+
+using UpgradeableSetTypes = boost::mpl::list<
+    atomic_rw_upgradeable<std::set<int>>,
+    atomic_rw_base<std::set<int>, distributed_shared_mutex, std::unique_lock,
+                   std::shared_lock, layout::compact, std::timed_mutex>>;
+
+// the upgrade gate is opt-in, and takes no space without it
+static_assert(!atomic_rw<int>::is_upgradeable);
+static_assert(atomic_rw_upgradeable<int>::is_upgradeable);
+static_assert(sizeof(atomic_rw<int>) < sizeof(atomic_rw_upgradeable<int>));
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(ReadTest, RW, SetTypes) {
+  RW async_set{1, 4, 5, 6};
   BOOST_CHECK(async_set.copy() == (std::set<int>{1, 4, 5, 6}));
   async_set.assign(4, 6, 7, 9);
   BOOST_CHECK(async_set.copy() == (std::set<int>{4, 6, 7, 9}));
@@ -57,8 +79,8 @@ BOOST_AUTO_TEST_CASE(ReadTest) {
   f5.get();
 }
 
-BOOST_AUTO_TEST_CASE(WriteTest) {
-  atomic_rw<std::set<int>> async_set{1, 4, 5, 6};
+BOOST_AUTO_TEST_CASE_TEMPLATE(WriteTest, RW, SetTypes) {
+  RW async_set{1, 4, 5, 6};
   const auto& const_async_set = async_set;
   auto read_func = [&const_async_set]() {
     for (size_t ii{0}; ii < 100; ++ii) {
@@ -110,4 +132,253 @@ BOOST_AUTO_TEST_CASE(WriteTest) {
   f1.get();
   f2.get();
   f3.get();
-}
\ No newline at end of file
+}
+
+BOOST_AUTO_TEST_CASE(DistributedSharedMutexTest) {
+  distributed_shared_mutex mutex;
+  BOOST_CHECK_GE(mutex.slot_count(), 1u);
+
+  // readers share, writers exclude everyone
+  BOOST_CHECK(mutex.try_lock_shared());
+  BOOST_CHECK(mutex.try_lock_shared());
+  BOOST_CHECK(!mutex.try_lock());
+  mutex.unlock_shared();
+  BOOST_CHECK(!mutex.try_lock());
+  mutex.unlock_shared();
+
+  BOOST_CHECK(mutex.try_lock());
+  BOOST_CHECK(!mutex.try_lock());
+  BOOST_CHECK(!mutex.try_lock_shared());
+  auto reader = std::async(std::launch::async, [&mutex]() {
+    return mutex.try_lock_shared();
+  });
+  BOOST_CHECK(!reader.get());
+  mutex.unlock();
+
+  BOOST_CHECK(mutex.try_lock_shared());
+  mutex.unlock_shared();
+}
+
+BOOST_AUTO_TEST_CASE(ScalableConsistencyTest) {
+  // writers keep both elements equal, readers must never see them differ
+  atomic_rw_scalable<std::pair<long, long>> pair;
+  const int per_thread = 5000;
+
+  auto write_func = [&pair]() {
+    for (int ii{0}; ii < per_thread; ii++) {
+      auto proxy = pair.write();
+      proxy->first++;
+      proxy->second++;
+    }
+  };
+
+  auto read_func = [&pair]() {
+    long torn{0};
+    for (int ii{0}; ii < 4 * per_thread; ii++) {
+      auto proxy = pair.read();
+      torn += proxy->first != proxy->second;
+    }
+    return torn;
+  };
+
+  std::vector<std::future<long>> readers;
+  for (int tt{0}; tt < 4; tt++) {
+    readers.push_back(std::async(std::launch::async, read_func));
+  }
+  auto w1 = std::async(std::launch::async, write_func);
+  auto w2 = std::async(std::launch::async, write_func);
+  w1.get();
+  w2.get();
+  for (auto& r : readers) {
+    BOOST_CHECK_EQUAL(r.get(), 0);
+  }
+  BOOST_CHECK_EQUAL(pair->first, 2L * per_thread);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(UpgradeableReadTest, RW, UpgradeableSetTypes) {
+  using namespace std::chrono_literals;
+  RW async_set{1, 2};
+  const auto version = async_set.version();
+
+  auto upgradeable = async_set.upgradeable_read();
+  BOOST_CHECK_EQUAL(upgradeable->size(), 2u);
+  BOOST_CHECK_EQUAL((*upgradeable).count(1), 1u);
+
+  // plain readers coexist with an upgrader
+  auto reader = std::async(std::launch::async,
+                           [&async_set]() { return async_set->size(); });
+  BOOST_CHECK_EQUAL(reader.get(), 2u);
+
+  // writers and other upgraders wait
+  auto writer = std::async(std::launch::async,
+                           [&async_set]() { async_set.write()->insert(3); });
+  auto upgrader = std::async(std::launch::async, [&async_set]() {
+    return async_set.upgradeable_read()->size();
+  });
+  BOOST_CHECK(writer.wait_for(20ms) == std::future_status::timeout);
+  BOOST_CHECK(upgrader.wait_for(1ms) == std::future_status::timeout);
+
+  // only the upgrade bumps the version
+  BOOST_CHECK_EQUAL(async_set.version(), version);
+  {
+    auto write_proxy = std::move(upgradeable).upgrade();
+    BOOST_CHECK_EQUAL(write_proxy->size(), 2u);  // nobody got in before us
+    BOOST_CHECK_EQUAL(async_set.version(), version + 1);
+    write_proxy->insert(4);
+  }
+
+  writer.get();
+  BOOST_CHECK_GE(upgrader.get(), 3u);
+  BOOST_CHECK(async_set.copy() == (std::set<int>{1, 2, 3, 4}));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(UpgradeableCheckThenUpdateTest, RW,
+                              UpgradeableSetTypes) {
+  RW async_set;
+
+  // each thread inserts 0..99 only if missing, so each insert happens once
+  auto func = [&async_set]() {
+    int inserted{0};
+    for (int ii{0}; ii < 100; ii++) {
+      auto proxy = async_set.upgradeable_read();
+      if (proxy->count(ii) == 0) {
+        const auto result = std::move(proxy).upgrade()->insert(ii);
+        inserted += result.second;
+      }
+    }
+    return inserted;
+  };
+
+  std::vector<std::future<int>> futures;
+  for (int tt{0}; tt < 4; tt++) {
+    futures.push_back(std::async(std::launch::async, func));
+  }
+  int total{0};
+  for (auto& f : futures) {
+    total += f.get();
+  }
+  BOOST_CHECK_EQUAL(total, 100);
+  BOOST_CHECK_EQUAL(async_set->size(), 100u);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(VersionTest, RW, SetTypes) {
+  RW async_set{1, 2};
+  const auto first = async_set.copy_if_newer(0);
+  BOOST_REQUIRE(first);
+  BOOST_CHECK(first->first == (std::set<int>{1, 2}));
+  BOOST_CHECK_EQUAL(first->second, async_set.version());
+
+  // reads don't bump the version
+  async_set->size();
+  async_set.copy();
+  BOOST_CHECK(!async_set.copy_if_newer(first->second));
+
+  // assign and write do
+  auto last = first->second;
+  const auto check_bumped = [&async_set, &last](std::size_t size) {
+    const auto next = async_set.copy_if_newer(last);
+    BOOST_REQUIRE(next);
+    BOOST_CHECK_EQUAL(next->first.size(), size);
+    last = next->second;
+  };
+
+  async_set.assign(std::set<int>{1});
+  check_bumped(1);
+  async_set.write()->insert(2);
+  check_bumped(2);
+}
+
+using buffer = std::unique_ptr<std::vector<int>>;
+using BufferTypes =
+    boost::mpl::list<nil::atomic_rw<buffer>, nil::atomic_rw_scalable<buffer>>;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(MoveOnlyTest, RW, BufferTypes) {
+  RW async_buffer{std::make_unique<std::vector<int>>(3, 1)};
+  BOOST_CHECK_EQUAL(async_buffer->get()->size(), 3u);
+  async_buffer.write()->get()->push_back(2);
+  BOOST_CHECK_EQUAL(async_buffer.read()->get()->size(), 4u);
+
+  // swapping buffers moves them, never copies
+  auto fresh = std::make_unique<std::vector<int>>();
+  const auto* fresh_ptr = fresh.get();
+  auto old = async_buffer.exchange(std::move(fresh));
+  BOOST_REQUIRE(old);
+  BOOST_CHECK_EQUAL(old->size(), 4u);
+  BOOST_CHECK_EQUAL(async_buffer->get(), fresh_ptr);
+
+  auto taken = async_buffer.take();
+  BOOST_CHECK_EQUAL(taken.get(), fresh_ptr);
+  BOOST_CHECK(async_buffer->get() == nullptr);
+
+  const auto version = async_buffer.version();
+  BOOST_CHECK(!async_buffer.compare_exchange(taken, std::move(old)));
+  BOOST_CHECK_EQUAL(async_buffer.version(), version);
+  BOOST_CHECK(async_buffer.compare_exchange(nullptr, std::move(old)));
+  BOOST_CHECK_NE(async_buffer.version(), version);
+  BOOST_CHECK_EQUAL(async_buffer->get()->size(), 4u);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(CompareExchangeTest, RW, SetTypes) {
+  RW async_set{1};
+
+  std::set<int> expected{2};
+  BOOST_CHECK(!async_set.compare_exchange(expected, std::set<int>{3}));
+  BOOST_CHECK(expected == std::set<int>{1});
+  BOOST_CHECK(async_set.compare_exchange(expected, std::set<int>{3}));
+  BOOST_CHECK(async_set.copy() == std::set<int>{3});
+}
+
+BOOST_AUTO_TEST_CASE(CopyIntoTest) {
+  nil::atomic_rw<std::vector<double>> samples{std::vector<double>(16, 1.0)};
+
+  std::vector<double> out;
+  out.reserve(64);
+  const auto* storage = out.data();
+  samples.copy_into(out);
+  BOOST_CHECK(out == std::vector<double>(16, 1.0));
+  BOOST_CHECK_EQUAL(out.data(), storage);
+}
+
+BOOST_AUTO_TEST_CASE(TryReadWriteTest) {
+  using namespace std::chrono_literals;
+  atomic_rw_base<int, std::shared_timed_mutex, std::unique_lock,
+                 std::shared_lock>
+      value{1};
+  const auto& const_value = value;
+
+  {
+    auto reader = const_value.try_read();
+    BOOST_REQUIRE(reader);
+    BOOST_CHECK_EQUAL(**reader, 1);
+
+    // readers share, writers have to wait for them
+    BOOST_CHECK(const_value.try_read_for(1ms));
+    BOOST_CHECK(!value.try_write());
+    BOOST_CHECK(!value.try_write_for(1ms));
+  }
+
+  const auto version = value.version();
+  {
+    auto writer = value.try_write_for(1s);
+    BOOST_REQUIRE(writer);
+    **writer = 2;
+    BOOST_CHECK(!const_value.try_read());
+    BOOST_CHECK(!const_value.try_read_for(1ms));
+    BOOST_CHECK(!value.try_write());
+  }
+  BOOST_CHECK_NE(value.version(), version);
+  BOOST_CHECK_EQUAL(value.copy(), 2);
+
+  BOOST_CHECK(value.try_write());
+
+  // upgraders hold the gate, so writers can't get in either
+  atomic_rw_base<int, std::shared_timed_mutex, std::unique_lock,
+                 std::shared_lock, layout::compact, std::timed_mutex>
+      gated{1};
+  {
+    auto upgradeable = gated.upgradeable_read();
+    BOOST_CHECK(std::as_const(gated).try_read());
+    BOOST_CHECK(!gated.try_write_for(1ms));
+  }
+  BOOST_CHECK(gated.try_write());
+}
@@ -3,10 +3,17 @@
 
 #include "async/atomic.hpp"
 
+#include <atomic>
 #include <boost/test/unit_test.hpp>
+#include <chrono>
 #include <future>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
 
 using namespace nil;
 
@@ -67,4 +74,254 @@ BOOST_AUTO_TEST_CASE(MultithreadedTest) {
   auto vec = atomic_vec.peek();
   BOOST_CHECK_EQUAL(std::accumulate(vec.cbegin(), vec.cend(), 0),
                     counter_max * (counter_max + 1) / 2);
-}
\ No newline at end of file
+}
+BOOST_AUTO_TEST_CASE(WaitTest) {
+  using namespace std::chrono_literals;
+  nil::atomic<std::string> state{"starting"};
+
+  // already true, doesn't block
+  state.wait_until([](const auto& s) { return s == "starting"; });
+  BOOST_CHECK(!state.wait_for([](const auto& s) { return s.empty(); }, 1ms));
+
+  auto waiter = std::async(std::launch::async, [&state]() {
+    state.wait_until([](const auto& s) { return s == "running"; });
+  });
+  BOOST_CHECK(waiter.wait_for(20ms) == std::future_status::timeout);
+
+  // a change that doesn't satisfy the predicate keeps it waiting
+  state.push("loading");
+  BOOST_CHECK(waiter.wait_for(20ms) == std::future_status::timeout);
+
+  state.apply([](auto& s) { s = "running"; });
+  waiter.get();
+
+  auto timed = std::async(std::launch::async, [&state]() {
+    return state.wait_for([](const auto& s) { return s == "done"; }, 10s);
+  });
+  state.push("done");
+  BOOST_CHECK(timed.get());
+}
+
+BOOST_AUTO_TEST_CASE(UnchangedNoWakeTest) {
+  using namespace std::chrono_literals;
+  nil::atomic<int> value{0};
+  std::atomic<int> checks{0};
+
+  auto waiter = std::async(std::launch::async, [&]() {
+    value.wait_until([&checks](int v) {
+      checks++;
+      return v == 1;
+    });
+  });
+  while (checks.load() == 0) {
+    std::this_thread::yield();
+  }
+  std::this_thread::sleep_for(20ms);
+
+  // failed compares don't change anything, so they don't wake the waiter
+  for (int ii{0}; ii < 100; ii++) {
+    BOOST_CHECK(!value.compare_exchange(5, 1));
+  }
+  std::this_thread::sleep_for(20ms);
+  BOOST_CHECK_EQUAL(checks.load(), 1);
+
+  value.push(1);
+  waiter.get();
+  BOOST_CHECK_EQUAL(checks.load(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(MultithreadedWaitTest) {
+  nil::atomic<std::vector<int>> atomic_vec;
+  const int count = 1000;
+
+  // waiters for every stage wake as soon as it's reached
+  std::vector<std::future<void>> waiters;
+  for (int tt{1}; tt <= 4; tt++) {
+    waiters.push_back(std::async(std::launch::async, [&, tt]() {
+      atomic_vec.wait_until([&](const auto& vec) {
+        return vec.size() >= static_cast<size_t>(tt * count / 4);
+      });
+    }));
+  }
+  for (int ii{0}; ii < count; ii++) {
+    atomic_vec.apply([ii](auto& vec) { vec.push_back(ii); });
+  }
+  for (auto& w : waiters) {
+    w.get();
+  }
+  BOOST_CHECK_EQUAL(atomic_vec.peek().size(), static_cast<size_t>(count));
+}
+
+BOOST_AUTO_TEST_CASE(VersionTest) {
+  nil::atomic<std::string> config{"v1"};
+  static_assert(sizeof(decltype(config)::version_type) == 8,
+                "versions must not wrap, like atomic_rw's");
+  const auto first = config.peek_if_newer(0);
+  BOOST_REQUIRE(first);
+  BOOST_CHECK_EQUAL(first->first, "v1");
+  BOOST_CHECK_EQUAL(first->second, config.version());
+
+  // unchanged, nothing copied
+  BOOST_CHECK(!config.peek_if_newer(first->second));
+  const auto& const_config = config;
+  const_config.peek();
+  const_config.apply([](const auto&) {});
+  BOOST_CHECK(!config.peek_if_newer(first->second));
+
+  // every mutation bumps the version
+  config.push("v2");
+  const auto second = config.peek_if_newer(first->second);
+  BOOST_REQUIRE(second);
+  BOOST_CHECK_EQUAL(second->first, "v2");
+  BOOST_CHECK_NE(second->second, first->second);
+
+  config.apply([](auto& s) { s += "b"; });
+  const auto third = config.peek_if_newer(second->second);
+  BOOST_REQUIRE(third);
+  BOOST_CHECK_EQUAL(third->first, "v2b");
+}
+
+BOOST_AUTO_TEST_CASE(MultithreadedVersionTest) {
+  nil::atomic<std::vector<int>> atomic_vec;
+  const int count = 1000;
+
+  // a poller never sees the same version twice, and sees the data grow
+  auto poller = std::async(std::launch::async, [&]() {
+    decltype(atomic_vec)::version_type last{0};
+    std::size_t size{0};
+    bool ok{true};
+    while (size < static_cast<std::size_t>(count)) {
+      if (const auto next = atomic_vec.peek_if_newer(last)) {
+        ok = ok && next->second != last && next->first.size() >= size;
+        last = next->second;
+        size = next->first.size();
+      }
+    }
+    return ok;
+  });
+  for (int ii{0}; ii < count; ii++) {
+    atomic_vec.apply([ii](auto& vec) { vec.push_back(ii); });
+  }
+  BOOST_CHECK(poller.get());
+}
+
+BOOST_AUTO_TEST_CASE(ScalarPushTest) {
+  nil::atomic<int> a{1};
+  a.push(2);
+  BOOST_CHECK_EQUAL(a.peek(), 2);
+  BOOST_CHECK_EQUAL(a.exchange(3), 2);
+  BOOST_CHECK_EQUAL(a.take(), 3);
+  BOOST_CHECK_EQUAL(a.peek(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(MoveOnlyTest) {
+  using buffer = std::unique_ptr<std::vector<int>>;
+  nil::atomic<buffer> a{std::make_unique<std::vector<int>>(3, 1)};
+  BOOST_CHECK_EQUAL(a.apply([](const auto& b) { return b->size(); }), 3u);
+
+  // swapping buffers moves them, never copies
+  auto fresh = std::make_unique<std::vector<int>>();
+  const auto* fresh_ptr = fresh.get();
+  auto old = a.exchange(std::move(fresh));
+  BOOST_REQUIRE(old);
+  BOOST_CHECK_EQUAL(old->size(), 3u);
+  BOOST_CHECK_EQUAL(a.apply([](const auto& b) { return b.get(); }), fresh_ptr);
+
+  auto taken = a.take();
+  BOOST_CHECK_EQUAL(taken.get(), fresh_ptr);
+  BOOST_CHECK(a.apply([](const auto& b) { return b == nullptr; }));
+
+  // expected is left alone for move-only types
+  buffer expected;
+  BOOST_CHECK(a.compare_exchange(expected, std::move(old)));
+  BOOST_CHECK(!a.compare_exchange(expected, std::move(taken)));
+  BOOST_CHECK(taken);  // not moved from on failure
+  BOOST_CHECK(a.apply([](const auto& b) { return b && b->size() == 3; }));
+}
+
+BOOST_AUTO_TEST_CASE(CompareExchangeTest) {
+  nil::atomic<std::string> a{"one"};
+
+  // on failure, expected gets the current value, like std::atomic
+  std::string expected = "two";
+  BOOST_CHECK(!a.compare_exchange(expected, "three"));
+  BOOST_CHECK_EQUAL(expected, "one");
+  BOOST_CHECK(a.compare_exchange(expected, "three"));
+  BOOST_CHECK_EQUAL(a.peek(), "three");
+
+  // failures don't count as changes
+  const auto version = a.version();
+  BOOST_CHECK(!a.compare_exchange(std::string{"one"}, "four"));
+  BOOST_CHECK_EQUAL(a.version(), version);
+}
+
+BOOST_AUTO_TEST_CASE(MultithreadedCompareExchangeTest) {
+  nil::atomic<int> counter{0};
+  const int count = 1000;
+
+  // a classic CAS loop, every increment lands exactly once
+  auto func = [&counter]() {
+    for (int ii{0}; ii < count; ii++) {
+      auto expected = counter.peek();
+      while (!counter.compare_exchange(expected, expected + 1)) {
+      }
+    }
+  };
+  auto f1 = std::async(std::launch::async, func);
+  auto f2 = std::async(std::launch::async, func);
+  f1.get();
+  f2.get();
+  BOOST_CHECK_EQUAL(counter.peek(), 2 * count);
+}
+
+BOOST_AUTO_TEST_CASE(PeekIntoTest) {
+  nil::atomic<std::vector<double>> samples{std::vector<double>(16, 1.0)};
+
+  // reuses the caller's capacity, instead of allocating a new vector
+  std::vector<double> out;
+  out.reserve(64);
+  const auto* storage = out.data();
+  samples.peek_into(out);
+  BOOST_CHECK_EQUAL(out.size(), 16u);
+  BOOST_CHECK_EQUAL(out.data(), storage);
+
+  samples.apply([](auto& v) { v.assign(32, 2.0); });
+  samples.peek_into(out);
+  BOOST_CHECK(out == std::vector<double>(32, 2.0));
+  BOOST_CHECK_EQUAL(out.data(), storage);
+}
+
+BOOST_AUTO_TEST_CASE(TryApplyTest) {
+  using namespace std::chrono_literals;
+  atomic_base<int, std::timed_mutex, std::lock_guard> counter{0};
+  const auto& const_counter = counter;
+
+  BOOST_CHECK(counter.try_push(1));
+  BOOST_CHECK(counter.try_apply([](int& i) { i++; }));
+  BOOST_CHECK(counter.try_apply_for([](int& i) { i++; }, 1s));
+  BOOST_CHECK_EQUAL(*const_counter.try_apply([](int i) { return i * 10; }), 30);
+
+  // while another thread holds the lock, nothing waits for it
+  std::promise<void> locked;
+  std::promise<void> release;
+  auto holder = std::async(std::launch::async, [&]() {
+    counter.apply([&](int&) {
+      locked.set_value();
+      release.get_future().wait();
+    });
+  });
+  locked.get_future().wait();
+  const auto version = counter.version();
+
+  BOOST_CHECK(!counter.try_push(5));
+  BOOST_CHECK(!counter.try_apply([](int& i) { i = 5; }));
+  BOOST_CHECK(!const_counter.try_apply([](int i) { return i; }));
+  BOOST_CHECK(!counter.try_apply_for([](int& i) { i = 5; }, 1ms));
+  BOOST_CHECK(!const_counter.try_apply_for([](int i) { return i; }, 1ms));
+  BOOST_CHECK_EQUAL(counter.version(), version);
+
+  release.set_value();
+  holder.get();
+  BOOST_CHECK_EQUAL(*const_counter.try_apply_for([](int i) { return i; }, 1s),
+                    3);
+}
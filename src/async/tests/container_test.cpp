@@ -3,10 +3,16 @@
 
 #include <boost/mpl/list.hpp>
 #include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <deque>
 #include <future>
 #include <meta/none_such.hpp>
+#include <mutex>
 #include <numeric>
+#include <thread>
 
+#include "async/combining_deque.hpp"
+#include "async/combining_vector.hpp"
 #include "async/deque.hpp"
 #include "async/list.hpp"
 #include "async/vector.hpp"
@@ -40,9 +46,12 @@ void VerifySize(const CT& c, typename CT::size_type expected_size) {
   BOOST_CHECK_EQUAL(c.empty(), (expected_size == 0));
 }
 
-using IntTypes = boost::mpl::list<vector<int>, deque<int>, list<int>>;
-using StrTypes = boost::mpl::list<vector<std::string>, deque<std::string>,
-                                  list<std::string>>;
+using IntTypes = boost::mpl::list<vector<int>, deque<int>, list<int>,
+                                  combining_vector<int>, combining_deque<int>>;
+using StrTypes =
+    boost::mpl::list<vector<std::string>, deque<std::string>, list<std::string>,
+                     combining_vector<std::string>,
+                     combining_deque<std::string>>;
 
 BOOST_AUTO_TEST_CASE_TEMPLATE(ConstructAssignTest, CT, StrTypes) {
   using container_type = typename CT::container_type;
@@ -80,6 +89,34 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(AtTest, CT, StrTypes) {
   VerifyAt(async_vec, {}, {}, 0, {});
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE(AtIntoTest, CT, StrTypes) {
+  CT async_vec;
+  std::string out = "untouched";
+  BOOST_CHECK(!async_vec.front_into(out));
+  BOOST_CHECK(!async_vec.back_into(out));
+  BOOST_CHECK_EQUAL(out, "untouched");
+
+  async_vec.push_back("first");
+  async_vec.push_back("second");
+
+  // copies into the existing string, without reallocating it
+  out.reserve(64);
+  const auto* storage = out.data();
+  BOOST_CHECK(async_vec.front_into(out));
+  BOOST_CHECK_EQUAL(out, "first");
+  BOOST_CHECK(async_vec.back_into(out));
+  BOOST_CHECK_EQUAL(out, "second");
+  BOOST_CHECK_EQUAL(static_cast<const void*>(out.data()),
+                    static_cast<const void*>(storage));
+
+  if constexpr (CT::is_vector_like || CT::is_deque_like) {
+    BOOST_CHECK(async_vec.at_into(0, out));
+    BOOST_CHECK_EQUAL(out, "first");
+    BOOST_CHECK(!async_vec.at_into(2, out));
+    BOOST_CHECK_EQUAL(out, "first");
+  }
+}
+
 BOOST_AUTO_TEST_CASE_TEMPLATE(PushPopBackTest, CT, StrTypes) {
   using container_type = typename CT::container_type;
   CT async_vec;
@@ -238,8 +275,8 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(PushExtractMultithreadTest, CT, IntTypes) {
   });
 
   f1.get();
+  BOOST_CHECK(f3.get());  // f3 polls f2, so it must finish before f2.get()
   f2.get();
-  BOOST_CHECK(f3.get());
   BOOST_CHECK_EQUAL(c_in.size(), c_out.size());
   BOOST_CHECK_EQUAL(total, std::accumulate(c_out.cbegin(), c_out.cend(), 0));
 }
@@ -268,7 +305,8 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(ApplyMultiThreadTest, CT, IntTypes) {
 }
 
 using MoveOnlyTypes =
-    boost::mpl::list<vector<MoveOnly>, deque<MoveOnly>, list<MoveOnly>>;
+    boost::mpl::list<vector<MoveOnly>, deque<MoveOnly>, list<MoveOnly>,
+                     combining_vector<MoveOnly>, combining_deque<MoveOnly>>;
 
 BOOST_AUTO_TEST_CASE_TEMPLATE(MoveOnlyTypeTest, CT, MoveOnlyTypes) {
   using container_type = typename CT::container_type;
@@ -304,3 +342,212 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(MoveOnlyTypeTest, CT, MoveOnlyTypes) {
   async_vec.assign(std::move(underlying));
   VerifySize(async_vec, 1);
 }
+
+using QueueTypes =
+    boost::mpl::list<deque<int>, list<int>, combining_deque<int>>;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(WaitExtractTest, CT, QueueTypes) {
+  using namespace std::chrono_literals;
+  CT async_vec{std::in_place, 1, 2};
+
+  // returns immediately when not empty
+  BOOST_CHECK_EQUAL(async_vec.wait_extract_front(), 1);
+  BOOST_CHECK_EQUAL(async_vec.wait_extract_back_for(1s).value(), 2);
+
+  // times out when empty
+  BOOST_CHECK(async_vec.wait_extract_front_for(10ms) == std::nullopt);
+  BOOST_CHECK(async_vec.wait_extract_back_until(
+                  std::chrono::steady_clock::now() + 10ms) == std::nullopt);
+
+  auto waiter = std::async(std::launch::async,
+                           [&]() { return async_vec.wait_extract_front(); });
+  auto timed_waiter = std::async(std::launch::async, [&]() {
+    return async_vec.wait_extract_back_for(10s);
+  });
+  std::this_thread::sleep_for(10ms);
+  async_vec.push_back(5);
+  async_vec.push_front(6);
+  BOOST_CHECK_EQUAL(waiter.get() + timed_waiter.get().value(), 11);
+  VerifySize(async_vec, 0);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(WaitExtractMultithreadTest, CT, QueueTypes) {
+  CT async_vec;
+  const int num_elements = 10000;
+  const int num_consumers = 4;
+
+  auto consumer = [&]() {
+    long sum = 0;
+    while (true) {
+      const auto v = async_vec.wait_extract_front();
+      if (v < 0) {
+        return sum;
+      }
+      sum += v;
+    }
+  };
+
+  std::vector<std::future<long>> consumers;
+  for (int ii{0}; ii < num_consumers; ii++) {
+    consumers.push_back(std::async(std::launch::async, consumer));
+  }
+
+  for (int ii{0}; ii < num_elements; ii++) {
+    if (ii % 3 == 0) {
+      async_vec.insert(0, ii);
+    } else {
+      async_vec.push_back(ii);
+    }
+  }
+  for (int ii{0}; ii < num_consumers; ii++) {
+    async_vec.push_back(-1);
+  }
+
+  long total = 0;
+  for (auto& f : consumers) {
+    total += f.get();
+  }
+  BOOST_CHECK_EQUAL(total, static_cast<long>(num_elements) *
+                               (num_elements - 1) / 2);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(BatchPushTest, CT, IntTypes) {
+  using container_type = typename CT::container_type;
+  CT async_vec;
+
+  const std::vector<int> range{1, 2, 3};
+  async_vec.push_back_range(range.cbegin(), range.cend());
+  VerifyAt(async_vec, 1, 3, 3, {1, 2, 3});
+
+  async_vec.push_back_bulk(container_type{4, 5});
+  VerifyAt(async_vec, 1, 5, 5, {1, 2, 3, 4, 5});
+
+  async_vec.clear();
+  async_vec.push_back_bulk(container_type{6, 7});
+  VerifyAt(async_vec, 6, 7, 2, {6, 7});
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(BatchExtractTest, CT, IntTypes) {
+  using container_type = typename CT::container_type;
+  CT async_vec{std::in_place, 1, 2, 3, 4, 5};
+
+  std::vector<int> out;
+  BOOST_CHECK_EQUAL(async_vec.extract_front_n(2, std::back_inserter(out)), 2u);
+  BOOST_CHECK(out == (std::vector<int>{1, 2}));
+  VerifyAt(async_vec, 3, 5, 3, {3, 4, 5});
+
+  BOOST_CHECK_EQUAL(async_vec.drain(std::back_inserter(out)), 3u);
+  BOOST_CHECK(out == (std::vector<int>{1, 2, 3, 4, 5}));
+  VerifySize(async_vec, 0);
+
+  BOOST_CHECK_EQUAL(async_vec.extract_front_n(2, std::back_inserter(out)), 0u);
+  BOOST_CHECK_EQUAL(async_vec.drain(std::back_inserter(out)), 0u);
+
+  async_vec.assign(std::in_place, 8, 9);
+  BOOST_CHECK(async_vec.swap_out() == (container_type{8, 9}));
+  VerifySize(async_vec, 0);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(BatchMoveOnlyTest, CT, MoveOnlyTypes) {
+  using container_type = typename CT::container_type;
+  CT async_vec;
+
+  container_type bulk;
+  bulk.emplace_back();
+  bulk.emplace_back();
+  async_vec.push_back_bulk(std::move(bulk));
+  bulk.emplace_back();
+  async_vec.push_back_bulk(std::move(bulk));
+  VerifySize(async_vec, 3);
+
+  std::vector<MoveOnly> out;
+  BOOST_CHECK_EQUAL(async_vec.extract_front_n(1, std::back_inserter(out)), 1u);
+  BOOST_CHECK_EQUAL(async_vec.drain(std::back_inserter(out)), 2u);
+  BOOST_CHECK_EQUAL(out.size(), 3u);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(BatchMultithreadTest, CT, QueueTypes) {
+  using container_type = typename CT::container_type;
+  CT async_vec;
+  const int num_batches = 1000;
+  const int batch_size = 10;
+
+  auto producer = std::async(std::launch::async, [&]() {
+    for (int ii{0}; ii < num_batches; ii++) {
+      container_type batch;
+      for (int jj{0}; jj < batch_size; jj++) {
+        batch.push_back(ii * batch_size + jj);
+      }
+      if (ii % 2 == 0) {
+        async_vec.push_back_bulk(std::move(batch));
+      } else {
+        async_vec.push_back_range(batch.cbegin(), batch.cend());
+      }
+    }
+  });
+
+  std::vector<int> out;
+  while (out.size() < num_batches * batch_size) {
+    if (out.size() % 2 == 0) {
+      async_vec.extract_front_n(7, std::back_inserter(out));
+    } else {
+      async_vec.drain(std::back_inserter(out));
+    }
+  }
+  producer.get();
+
+  for (int ii{0}; ii < num_batches * batch_size; ii++) {
+    BOOST_REQUIRE_EQUAL(out[ii], ii);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TryOpsTest) {
+  using namespace std::chrono_literals;
+  using container_type = std::deque<int>;
+  container_base<container_type, std::timed_mutex, std::lock_guard> queue;
+  const auto& const_queue = queue;
+
+  BOOST_CHECK(queue.try_push_back(2));
+  BOOST_CHECK(queue.try_push_front(1));
+  BOOST_CHECK(queue.try_apply([](container_type& c) { c.push_back(3); }));
+  const auto size = [](const container_type& c) { return c.size(); };
+  BOOST_CHECK_EQUAL(*const_queue.try_apply(size), 3u);
+  BOOST_CHECK_EQUAL(*queue.try_extract_front(), 1);
+  BOOST_CHECK_EQUAL(*queue.try_extract_back(), 3);
+
+  // while another thread holds the lock, nothing waits for it
+  std::promise<void> locked;
+  std::promise<void> release;
+  auto holder = std::async(std::launch::async, [&]() {
+    queue.apply([&](container_type&) {
+      locked.set_value();
+      release.get_future().wait();
+    });
+  });
+  locked.get_future().wait();
+
+  BOOST_CHECK(!queue.try_push_back(4));
+  BOOST_CHECK(!queue.try_push_front(0));
+  BOOST_CHECK(!queue.try_extract_back());
+  BOOST_CHECK(!queue.try_extract_front());
+  const auto clear = [](container_type& c) { c.clear(); };
+  BOOST_CHECK(!queue.try_apply(clear));
+  BOOST_CHECK(!queue.try_apply_for(clear, 1ms));
+  BOOST_CHECK(!const_queue.try_apply(size));
+  BOOST_CHECK(!const_queue.try_apply_for(size, 1ms));
+
+  release.set_value();
+  holder.get();
+  BOOST_CHECK(
+      queue.try_apply_for([](container_type& c) { c.push_back(5); }, 1s));
+  VerifyAt(queue, 2, 5, 2, {2, 5});
+}
+
+BOOST_AUTO_TEST_CASE(TryPushWakesWaiterTest) {
+  deque<int> queue;
+  auto waiter = std::async(std::launch::async,
+                           [&queue]() { return queue.wait_extract_front(); });
+  while (!queue.try_push_back(7)) {
+  }
+  BOOST_CHECK_EQUAL(waiter.get(), 7);
+}
@@ -5,7 +5,12 @@
 
 #include <boost/mpl/list.hpp>
 #include <boost/test/unit_test.hpp>
+#include <deque>
+#include <list>
+#include <map>
 #include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #include "async/container_base.hpp"
 
@@ -153,4 +158,17 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(ListTraitTest, T, VectorTypes) {
   BOOST_CHECK(CT::is_list_like);
   BOOST_CHECK((is_list_like_v<C>));
   BOOST_CHECK((is_list_like_v<C, V, S, I>));
-}
\ No newline at end of file
+}
+
+BOOST_AUTO_TEST_CASE(SpliceTraitTest) {
+  BOOST_CHECK((exists_v<splice_func, std::list<int>>));
+  BOOST_CHECK((!exists_v<splice_func, std::vector<int>>));
+  BOOST_CHECK((!exists_v<splice_func, std::deque<int>>));
+}
+
+BOOST_AUTO_TEST_CASE(MapTraitTest) {
+  BOOST_CHECK((is_map_like_v<std::unordered_map<int, std::string>>));
+  BOOST_CHECK((is_map_like_v<std::unordered_map<std::string, MoveOnly>>));
+  BOOST_CHECK((is_map_like_v<std::map<int, int>>));
+  BOOST_CHECK((!is_map_like_v<std::vector<int>, int, int>));
+}
@@ -0,0 +1,118 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE flat_combining_mutex_test
+
+#include "async/flat_combining_mutex.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "async/combining_deque.hpp"
+#include "async/combining_vector.hpp"
+
+using namespace nil;
+using namespace nil::async;
+
+BOOST_AUTO_TEST_CASE(CombineTest) {
+  flat_combining_mutex mutex;
+  BOOST_CHECK(mutex.slot_count() >= 1);
+
+  int value{0};
+  mutex.combine([&value]() { value = 3; });
+  BOOST_CHECK_EQUAL(value, 3);
+  BOOST_CHECK_EQUAL(mutex.combine([&value]() { return value * 2; }), 6);
+
+  // move-only results come back by move
+  auto ptr = mutex.combine([]() { return std::make_unique<int>(5); });
+  BOOST_CHECK_EQUAL(*ptr, 5);
+
+  // combine takes the lock, so it's free again afterwards
+  BOOST_CHECK(mutex.try_lock());
+  mutex.unlock();
+}
+
+BOOST_AUTO_TEST_CASE(ExceptionTest) {
+  flat_combining_mutex mutex;
+  BOOST_CHECK_THROW(
+      mutex.combine([]() -> int { throw std::runtime_error("oops"); }),
+      std::runtime_error);
+  BOOST_CHECK_EQUAL(mutex.combine([]() { return 1; }), 1);
+}
+
+BOOST_AUTO_TEST_CASE(MutualExclusionTest) {
+  flat_combining_mutex mutex;
+  long counter{0};  // deliberately not atomic
+  const int per_thread = 20000;
+
+  // half the threads combine, the other half lock as usual
+  auto combiner = [&]() {
+    for (int ii{0}; ii < per_thread; ii++) {
+      mutex.combine([&counter]() { counter++; });
+    }
+  };
+  auto locker = [&]() {
+    for (int ii{0}; ii < per_thread; ii++) {
+      std::lock_guard<flat_combining_mutex> lock{mutex};
+      counter++;
+    }
+  };
+
+  std::vector<std::future<void>> futures;
+  for (int tt{0}; tt < 4; tt++) {
+    futures.push_back(std::async(std::launch::async, combiner));
+    futures.push_back(std::async(std::launch::async, locker));
+  }
+  for (auto& f : futures) {
+    f.get();
+  }
+  BOOST_CHECK_EQUAL(counter, 8L * per_thread);
+}
+
+BOOST_AUTO_TEST_CASE(CombiningVectorTest) {
+  combining_vector<int> vec;
+  const int per_thread = 10000;
+  const int threads = 8;
+
+  std::vector<std::future<void>> futures;
+  for (int tt{0}; tt < threads; tt++) {
+    futures.push_back(std::async(std::launch::async, [&vec, tt]() {
+      for (int ii{0}; ii < per_thread; ii++) {
+        vec.push_back(tt * per_thread + ii);
+      }
+    }));
+  }
+  for (auto& f : futures) {
+    f.get();
+  }
+
+  // every push ran exactly once, and each thread's pushes kept their order
+  BOOST_REQUIRE_EQUAL(vec.size(), std::size_t{threads * per_thread});
+  std::vector<int> last(threads, -1);
+  vec.apply_each([&last](int v) {
+    auto& seen = last[v / per_thread];
+    BOOST_CHECK_LT(seen, v);
+    seen = v;
+  });
+}
+
+BOOST_AUTO_TEST_CASE(CombiningDequeTest) {
+  combining_deque<std::string> queue;
+
+  auto consumer = std::async(std::launch::async, [&queue]() {
+    std::size_t total{0};
+    for (int ii{0}; ii < 1000; ii++) {
+      total += queue.wait_extract_front().size();
+    }
+    return total;
+  });
+  for (int ii{0}; ii < 1000; ii++) {
+    queue.push_back(std::string(3, 'x'));
+  }
+  BOOST_CHECK_EQUAL(consumer.get(), 3000u);
+  BOOST_CHECK(queue.empty());
+}
@@ -0,0 +1,84 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE latest_test
+
+#include "async/latest.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <future>
+#include <string>
+#include <vector>
+
+using namespace nil::async;
+
+BOOST_AUTO_TEST_CASE(BasicTest) {
+  latest<std::string> l;
+  BOOST_CHECK_EQUAL(l.buffer_count(), 3u);
+  BOOST_CHECK_EQUAL(l.peek(), "");
+
+  l.push("hello");
+  BOOST_CHECK_EQUAL(l.peek(), "hello");
+  BOOST_CHECK_EQUAL(*l.read(), "hello");
+  BOOST_CHECK_EQUAL(l.read()->size(), 5u);
+
+  l.push(std::string{"yo"});
+  std::string out;
+  l.peek_into(out);
+  BOOST_CHECK_EQUAL(out, "yo");
+
+  latest<std::string, 5> init{"start"};
+  BOOST_CHECK_EQUAL(init.read().value(), "start");
+}
+
+BOOST_AUTO_TEST_CASE(PinnedReadTest) {
+  latest<std::string> l{"first"};
+
+  // a reader keeps seeing its buffer, no matter how often the writer pushes
+  auto proxy = l.read();
+  for (int ii{0}; ii < 10; ii++) {
+    l.push(std::to_string(ii));
+  }
+  BOOST_CHECK_EQUAL(*proxy, "first");
+  BOOST_CHECK_EQUAL(l.peek(), "9");
+
+  // and moving the proxy keeps the pin
+  auto moved = std::move(proxy);
+  l.push("10");
+  BOOST_CHECK_EQUAL(*moved, "first");
+}
+
+BOOST_AUTO_TEST_CASE(MultithreadedTest) {
+  // every element of a frame holds the frame's number
+  using frame = std::vector<int>;
+  const int frames = 20000;
+  const int readers = 3;
+  latest<frame, readers + 2> l{frame(256, 0)};
+
+  auto reader = [&l]() {
+    int last{0};
+    bool ok{true};
+    frame f;
+    while (last < frames) {
+      l.peek_into(f);
+      const auto number = f.front();
+      for (auto ii : f) {
+        ok = ok && ii == number;  // never torn
+      }
+      ok = ok && number >= last;  // never goes back in time
+      last = number;
+    }
+    return ok;
+  };
+
+  std::vector<std::future<bool>> futures;
+  for (int tt{0}; tt < readers; tt++) {
+    futures.push_back(std::async(std::launch::async, reader));
+  }
+  frame f(256);
+  for (int ii{1}; ii <= frames; ii++) {
+    f.assign(f.size(), ii);
+    l.push(f);
+  }
+  for (auto& fut : futures) {
+    BOOST_CHECK(fut.get());
+  }
+}
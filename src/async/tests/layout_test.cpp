@@ -0,0 +1,87 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE layout_test
+
+#include "async/layout.hpp"
+
+#include <boost/mpl/list.hpp>
+#include <boost/test/unit_test.hpp>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+#include "async/atomic.hpp"
+#include "async/atomic_rw_base.hpp"
+#include "async/container_base.hpp"
+#include "async/optional.hpp"
+
+using namespace nil;
+using namespace nil::async;
+
+template <class Layout>
+using atomic_t = atomic_base<int, std::mutex, std::lock_guard, Layout>;
+
+template <class Layout>
+using atomic_rw_t = atomic_rw_base<int, std::shared_mutex, std::unique_lock,
+                                   std::shared_lock, Layout>;
+
+template <class Layout>
+using optional_t = optional_base<int, std::optional, std::nullopt_t,
+                                 std::mutex, std::lock_guard, Layout>;
+
+template <class Layout>
+using vector_t =
+    container_base<std::vector<int>, std::mutex, std::lock_guard, Layout>;
+
+bool line_aligned(const void* p) {
+  return reinterpret_cast<std::uintptr_t>(p) % cache_line_size == 0;
+}
+
+BOOST_AUTO_TEST_CASE(CompactTest) {
+  // the default layout doesn't change anything
+  BOOST_CHECK((std::is_same_v<atomic<int>, atomic_t<layout::compact>>));
+  BOOST_CHECK((std::is_same_v<optional<int>, optional_t<layout::compact>>));
+  BOOST_CHECK_LT(sizeof(atomic<int>), cache_line_size);
+  BOOST_CHECK_LT(alignof(atomic<int>), cache_line_size);
+}
+
+using PaddedTypes =
+    boost::mpl::list<atomic_t<layout::padded>, atomic_rw_t<layout::padded>,
+                     optional_t<layout::padded>, vector_t<layout::padded>>;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(PaddedTest, W, PaddedTypes) {
+  BOOST_CHECK_EQUAL(alignof(W), cache_line_size);
+  BOOST_CHECK_EQUAL(sizeof(W) % cache_line_size, 0u);
+
+  // neighbours in an array never share a line
+  auto array = std::make_unique<W[]>(4);
+  for (int ii{0}; ii < 4; ii++) {
+    BOOST_CHECK(line_aligned(&array[ii]));
+  }
+}
+
+using SplitTypes =
+    boost::mpl::list<atomic_t<layout::split>, optional_t<layout::split>,
+                     vector_t<layout::split>>;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(SplitTest, W, SplitTypes) {
+  BOOST_CHECK_EQUAL(alignof(W), cache_line_size);
+  BOOST_CHECK_GE(sizeof(W), 2 * cache_line_size);
+
+  // the data starts on a line of its own
+  W w;
+  const void* data = w.apply([](const auto& t) { return &t; });
+  BOOST_CHECK(line_aligned(data));
+  BOOST_CHECK_NE(data, static_cast<const void*>(&w));
+}
+
+BOOST_AUTO_TEST_CASE(AliasTest) {
+  padded_atomic<int> a{1};
+  BOOST_CHECK_EQUAL(a.peek(), 1);
+  BOOST_CHECK_EQUAL(alignof(padded_atomic<int>), cache_line_size);
+
+  padded_optional<int> o{std::in_place, 2};
+  BOOST_CHECK_EQUAL(o.pop().value(), 2);
+  BOOST_CHECK_EQUAL(alignof(padded_optional<int>), cache_line_size);
+}
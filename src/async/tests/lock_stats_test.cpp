@@ -0,0 +1,171 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE lock_stats_test
+
+#ifndef NIL_ASYNC_LOCK_STATS
+#define NIL_ASYNC_LOCK_STATS
+#endif
+
+#include "async/lock_stats.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <shared_mutex>
+#include <sstream>
+#include <thread>
+
+#include "async/atomic_base.hpp"
+#include "async/atomic_rw_base.hpp"
+#include "async/container_base.hpp"
+#include "async/instrumented_mutex.hpp"
+#include "async/optional_base.hpp"
+
+using namespace nil;
+using namespace nil::async;
+
+using counted_mutex = instrumented_mutex<std::mutex>;
+
+lock_stats_snapshot find(const std::string& name) {
+  for (auto& s : lock_registry::global().snapshot()) {
+    if (s.name == name) {
+      return s;
+    }
+  }
+  BOOST_FAIL("no lock named " + name);
+  return {};
+}
+
+std::uint64_t total(const duration_histogram::counts_type& counts) {
+  std::uint64_t sum{0};
+  for (auto c : counts) {
+    sum += c;
+  }
+  return sum;
+}
+
+BOOST_AUTO_TEST_CASE(HistogramTest) {
+  using namespace std::chrono_literals;
+  duration_histogram h;
+  h.record(0ns);
+  for (int ii{0}; ii < 98; ii++) {
+    h.record(100ns);  // [64, 128)
+  }
+  h.record(5000ns);  // [4096, 8192)
+
+  const auto counts = h.counts();
+  BOOST_CHECK_EQUAL(total(counts), 100u);
+  BOOST_CHECK_EQUAL(counts[0], 1u);
+  BOOST_CHECK_EQUAL(counts[7], 98u);
+  BOOST_CHECK_EQUAL(counts[13], 1u);
+  BOOST_CHECK_EQUAL(duration_histogram::percentile(counts, 50), 128u);
+  BOOST_CHECK_EQUAL(duration_histogram::percentile(counts, 99.5), 8192u);
+  BOOST_CHECK_EQUAL(duration_histogram::percentile({}, 50), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(AtomicBaseTest) {
+  atomic_base<std::string, counted_mutex, std::lock_guard> a;
+  a.set_lock_name("atomic_base");
+  for (int ii{0}; ii < 10; ii++) {
+    a.push(std::to_string(ii));
+  }
+  a.peek();
+
+  const auto s = find("atomic_base");
+  BOOST_CHECK_EQUAL(s.acquisitions, 11u);
+  BOOST_CHECK_EQUAL(s.contended, 0u);
+  BOOST_CHECK_EQUAL(total(s.hold), 11u);
+  BOOST_CHECK_EQUAL(total(s.wait), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(SharedTest) {
+  atomic_rw_base<int, instrumented_mutex<std::shared_mutex>, std::unique_lock,
+                 std::shared_lock>
+      a{0};
+  a.set_lock_name("atomic_rw_base");
+  a.copy();
+  *a.write() = 1;
+
+  const auto s = find("atomic_rw_base");
+  BOOST_CHECK_EQUAL(s.acquisitions, 2u);
+  BOOST_CHECK_EQUAL(total(s.hold), 1u);  // shared holds aren't timed
+}
+
+BOOST_AUTO_TEST_CASE(TimedTest) {
+  using namespace std::chrono_literals;
+  atomic_base<int, instrumented_mutex<std::timed_mutex>, std::lock_guard> a;
+  a.set_lock_name("timed atomic_base");
+  BOOST_CHECK(a.try_apply_for([](int& i) { i++; }, 1s));
+  BOOST_CHECK_EQUAL(find("timed atomic_base").acquisitions, 1u);
+
+  atomic_rw_base<int, instrumented_mutex<std::shared_timed_mutex>,
+                 std::unique_lock, std::shared_lock>
+      rw{0};
+  rw.set_lock_name("timed atomic_rw_base");
+  {
+    auto reader = rw.try_read_for(1s);
+    BOOST_REQUIRE(reader);
+
+    // a timed lock that gives up isn't counted
+    BOOST_CHECK(!rw.try_write_for(1ms));
+  }
+  BOOST_CHECK(rw.try_write_for(1s));
+
+  const auto s = find("timed atomic_rw_base");
+  BOOST_CHECK_EQUAL(s.acquisitions, 2u);
+  BOOST_CHECK_EQUAL(total(s.hold), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(ContendedTest) {
+  container_base<std::vector<int>, counted_mutex, std::lock_guard> c;
+  c.set_lock_name("container_base");
+
+  // hold the lock from another thread long enough to make push_back wait
+  std::promise<void> locked;
+  auto holder = std::async(std::launch::async, [&c, &locked]() {
+    c.apply([&locked](std::vector<int>&) {
+      locked.set_value();
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    });
+  });
+  locked.get_future().wait();
+  c.push_back(1);
+  holder.get();
+
+  const auto s = find("container_base");
+  BOOST_CHECK_EQUAL(s.acquisitions, 2u);
+  BOOST_CHECK_EQUAL(s.contended, 1u);
+  BOOST_CHECK_EQUAL(total(s.wait), 1u);
+  BOOST_CHECK_GE(duration_histogram::percentile(s.wait, 50), 1u << 20);
+}
+
+BOOST_AUTO_TEST_CASE(SharedNameTest) {
+  optional_base<int, std::optional, std::nullopt_t, counted_mutex> o1;
+  optional_base<int, std::optional, std::nullopt_t, counted_mutex> o2;
+  o1.set_lock_name("optional_base");
+  o2.set_lock_name("optional_base");
+  o1.push(1);
+  o2.push(2);
+  BOOST_CHECK_EQUAL(find("optional_base").acquisitions, 2u);
+}
+
+BOOST_AUTO_TEST_CASE(DumpTest) {
+  atomic_base<std::string, counted_mutex, std::lock_guard> a;
+  a.set_lock_name("dump \"quoted\"");
+  a.push("1");
+
+  std::ostringstream text;
+  lock_registry::global().dump_text(text);
+  BOOST_CHECK(text.str().find("acquisitions") != std::string::npos);
+  BOOST_CHECK(text.str().find("dump \"quoted\"") != std::string::npos);
+
+  std::ostringstream json;
+  lock_registry::global().dump_json(json);
+  BOOST_CHECK_EQUAL(json.str().front(), '[');
+  BOOST_CHECK_EQUAL(json.str().back(), ']');
+  const auto entry = R"({"name":"dump \"quoted\"","acquisitions":1,)";
+  BOOST_CHECK(json.str().find(entry) != std::string::npos);
+
+  lock_registry::global().clear();
+  BOOST_CHECK(lock_registry::global().snapshot().empty());
+}
@@ -0,0 +1,121 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE mpmc_queue_test
+
+#include "async/mpmc_queue.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <future>
+#include <meta/none_such.hpp>
+#include <numeric>
+#include <string>
+
+using namespace nil;
+using namespace nil::async;
+
+BOOST_AUTO_TEST_CASE(CapacityTest) {
+  BOOST_CHECK_EQUAL(mpmc_queue<int>{0}.capacity(), 2u);
+  BOOST_CHECK_EQUAL(mpmc_queue<int>{2}.capacity(), 2u);
+  BOOST_CHECK_EQUAL(mpmc_queue<int>{5}.capacity(), 8u);
+  BOOST_CHECK_EQUAL(mpmc_queue<int>{1024}.capacity(), 1024u);
+}
+
+BOOST_AUTO_TEST_CASE(PushPopTest) {
+  mpmc_queue<std::string> q{4};
+  BOOST_CHECK(q.empty());
+  BOOST_CHECK(q.try_pop() == std::nullopt);
+
+  const std::string str{"1"};
+  BOOST_CHECK(q.try_push(str));
+  BOOST_CHECK(q.try_push(std::string{"2"}));
+  BOOST_CHECK(q.try_push("3"));
+  BOOST_CHECK(q.try_emplace(1, '4'));
+  BOOST_CHECK_EQUAL(q.size(), 4u);
+
+  std::string fifth{"5"};
+  BOOST_CHECK(!q.try_push(std::move(fifth)));
+  BOOST_CHECK_EQUAL(fifth, "5");  // untouched when full
+
+  BOOST_CHECK_EQUAL(q.try_pop().value(), "1");
+  BOOST_CHECK_EQUAL(q.try_pop().value(), "2");
+  BOOST_CHECK(q.try_push(std::move(fifth)));
+  BOOST_CHECK_EQUAL(q.try_pop().value(), "3");
+  BOOST_CHECK_EQUAL(q.try_pop().value(), "4");
+  BOOST_CHECK_EQUAL(q.try_pop().value(), "5");
+  BOOST_CHECK(q.try_pop() == std::nullopt);
+  BOOST_CHECK(q.empty());
+}
+
+BOOST_AUTO_TEST_CASE(MoveOnlyTest) {
+  mpmc_queue<std::unique_ptr<int>> q{2};
+  BOOST_CHECK(q.try_push(std::make_unique<int>(5)));
+  BOOST_CHECK(q.try_emplace(new int{6}));
+  BOOST_CHECK_EQUAL(*q.try_pop().value(), 5);
+  BOOST_CHECK_EQUAL(*q.try_pop().value(), 6);
+
+  mpmc_queue<MoveOnly> q2{2};
+  BOOST_CHECK(q2.try_push(MoveOnly{}));
+  BOOST_CHECK(q2.try_pop() != std::nullopt);
+}
+
+BOOST_AUTO_TEST_CASE(DestructorTest) {
+  auto counter = std::make_shared<int>(0);
+  {
+    mpmc_queue<std::shared_ptr<int>> q{8};
+    for (int ii{0}; ii < 5; ii++) {
+      q.try_push(counter);
+    }
+    BOOST_CHECK_EQUAL(counter.use_count(), 6);
+  }
+  BOOST_CHECK_EQUAL(counter.use_count(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(MultithreadedTest) {
+  mpmc_queue<int> q{64};
+  const int per_producer = 20000;
+  const int num_producers = 4;
+  const int num_consumers = 4;
+  std::atomic<int> consumed{0};
+
+  auto producer = [&](int offset) {
+    for (int ii{0}; ii < per_producer; ii++) {
+      while (!q.try_push(offset + ii)) {
+        std::this_thread::yield();
+      }
+    }
+  };
+
+  auto consumer = [&]() {
+    long sum = 0;
+    while (consumed.load() < num_producers * per_producer) {
+      if (auto v = q.try_pop()) {
+        sum += *v;
+        consumed++;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+    return sum;
+  };
+
+  std::vector<std::future<void>> producers;
+  std::vector<std::future<long>> consumers;
+  for (int ii{0}; ii < num_consumers; ii++) {
+    consumers.push_back(std::async(std::launch::async, consumer));
+  }
+  for (int ii{0}; ii < num_producers; ii++) {
+    producers.push_back(
+        std::async(std::launch::async, producer, ii * per_producer));
+  }
+
+  for (auto& f : producers) {
+    f.get();
+  }
+  long total = 0;
+  for (auto& f : consumers) {
+    total += f.get();
+  }
+
+  const long n = num_producers * per_producer;
+  BOOST_CHECK_EQUAL(total, n * (n - 1) / 2);
+  BOOST_CHECK(q.empty());
+}
@@ -4,9 +4,11 @@
 #include "async/optional.hpp"
 
 #include <boost/test/unit_test.hpp>
+#include <chrono>
 #include <future>
 #include <iostream>
 #include <numeric>
+#include <string>
 
 #include "async/atomic.hpp"
 
@@ -131,4 +133,29 @@ BOOST_AUTO_TEST_CASE(OptionalLikeTest) {
   op.pop();
   op.push(optional_like_null);
   op.apply([](const auto&) { return 5; });
-}
\ No newline at end of file
+}
+
+BOOST_AUTO_TEST_CASE(WaitTest) {
+  using namespace std::chrono_literals;
+  async::optional<std::string> async_optional;
+
+  BOOST_CHECK(!async_optional.wait_for(
+      [](const auto& opt) { return opt.has_value(); }, 1ms));
+
+  // wakes on push
+  auto waiter = std::async(std::launch::async, [&async_optional]() {
+    async_optional.wait_until([](const auto& opt) { return opt.has_value(); });
+    return async_optional.peek().value();
+  });
+  BOOST_CHECK(waiter.wait_for(20ms) == std::future_status::timeout);
+  async_optional.push("hello");
+  BOOST_CHECK_EQUAL(waiter.get(), "hello");
+
+  // wakes on pop
+  auto emptied = std::async(std::launch::async, [&async_optional]() {
+    return async_optional.wait_for(
+        [](const auto& opt) { return !opt.has_value(); }, 10s);
+  });
+  BOOST_CHECK(async_optional.pop().has_value());
+  BOOST_CHECK(emptied.get());
+}
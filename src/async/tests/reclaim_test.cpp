@@ -0,0 +1,167 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE reclaim_test
+
+#include <boost/mpl/list.hpp>
+#include <boost/test/unit_test.hpp>
+#include <future>
+#include <numeric>
+#include <optional>
+
+#include "async/epoch_domain.hpp"
+#include "async/hazard_domain.hpp"
+
+using namespace nil::async;
+
+std::atomic<int> live_nodes{0};
+
+struct Node {
+  static constexpr int canary = 0x5AFE;
+
+  explicit Node(int v) : value{v} { live_nodes++; }
+  ~Node() {
+    check = 0;
+    live_nodes--;
+  }
+
+  int value;
+  int check{canary};
+  Node* next{nullptr};
+};
+
+/** minimal Treiber stack to exercise a domain */
+template <class Domain>
+class Stack {
+ public:
+  explicit Stack(Domain& domain) : domain_{domain} {}
+
+  ~Stack() {
+    while (pop()) {
+    }
+  }
+
+  void push(int v) {
+    auto* n = new Node{v};
+    n->next = head_.load(std::memory_order_relaxed);
+    while (!head_.compare_exchange_weak(n->next, n)) {
+    }
+  }
+
+  /** returns nullopt when empty, or -1 if a freed node was observed */
+  std::optional<int> pop() {
+    auto guard = domain_.pin();
+    while (true) {
+      auto* n = guard.protect(head_);
+      if (!n) {
+        return std::nullopt;
+      }
+      if (n->check != Node::canary) {
+        return -1;
+      }
+      if (head_.compare_exchange_weak(n, n->next)) {
+        const auto v = n->value;
+        domain_.retire(n);
+        return v;
+      }
+    }
+  }
+
+ private:
+  Domain& domain_;
+  std::atomic<Node*> head_{nullptr};
+};
+
+using DomainTypes = boost::mpl::list<epoch_domain, hazard_domain>;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(ProtectedNodeIsNotFreedTest, Domain,
+                              DomainTypes) {
+  live_nodes = 0;
+  Domain domain;
+  std::atomic<Node*> head{new Node{1}};
+
+  {
+    auto guard = domain.pin();
+    auto* n = guard.protect(head);
+    head.store(nullptr);
+
+    // retired while protected, even after repeated collection attempts
+    domain.retire(n);
+    for (int ii{0}; ii < 10; ii++) {
+      domain.collect();
+    }
+    BOOST_CHECK_EQUAL(live_nodes.load(), 1);
+    BOOST_CHECK_EQUAL(n->check, Node::canary);
+    BOOST_CHECK_EQUAL(domain.pending(), 1u);
+  }
+
+  for (int ii{0}; ii < 10; ii++) {
+    domain.collect();
+  }
+  BOOST_CHECK_EQUAL(live_nodes.load(), 0);
+  BOOST_CHECK_EQUAL(domain.pending(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(BoundedGarbageTest, Domain, DomainTypes) {
+  live_nodes = 0;
+  Domain domain;
+
+  for (int ii{0}; ii < 10000; ii++) {
+    domain.retire(new Node{ii});
+    BOOST_REQUIRE_LE(domain.pending(), Domain::collect_threshold);
+  }
+  BOOST_CHECK_LE(live_nodes.load(), Domain::collect_threshold);
+}
+
+BOOST_AUTO_TEST_CASE(HazardSlotsTest) {
+  hazard_domain domain;
+  std::vector<hazard_domain::guard> guards;
+  for (std::size_t ii{0}; ii < hazard_domain::slots_per_thread; ii++) {
+    guards.push_back(domain.pin());
+  }
+  BOOST_CHECK_THROW(domain.pin(), std::length_error);
+  guards.pop_back();
+  BOOST_CHECK_NO_THROW(domain.pin());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(MultithreadedStackTest, Domain, DomainTypes) {
+  live_nodes = 0;
+  Domain domain;
+  {
+    Stack<Domain> stack{domain};
+    const int per_thread = 20000;
+
+    auto func = [&](int offset) {
+      long sum = 0;
+      for (int ii{0}; ii < per_thread; ii++) {
+        stack.push(offset + ii);
+        auto v = stack.pop();
+        if (!v || *v < 0) {
+          return -1L;
+        }
+        sum += *v;
+      }
+      domain.collect();
+      return sum;
+    };
+
+    std::vector<std::future<long>> futures;
+    for (int tt{0}; tt < 4; tt++) {
+      futures.push_back(std::async(std::launch::async, func, tt * per_thread));
+    }
+
+    long total = 0;
+    for (auto& f : futures) {
+      const auto sum = f.get();
+      BOOST_CHECK_GE(sum, 0);
+      total += sum;
+    }
+
+    const long n = 4L * per_thread;
+    BOOST_CHECK_EQUAL(total, n * (n - 1) / 2);
+  }
+
+  // worker threads have exited, anything they couldn't free yet is adopted
+  for (int ii{0}; ii < 10; ii++) {
+    domain.collect();
+  }
+  BOOST_CHECK_LE(live_nodes.load(), 4 * Domain::collect_threshold);
+}
@@ -0,0 +1,118 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE seqlock_atomic_test
+
+#include "async/seqlock_atomic.hpp"
+
+#include <algorithm>
+#include <array>
+#include <boost/test/unit_test.hpp>
+#include <future>
+#include <numeric>
+
+using namespace nil;
+
+struct Telemetry {
+  int a;
+  int b;
+  double c;
+  std::array<long, 13> d;
+};
+
+BOOST_AUTO_TEST_CASE(BasicTest) {
+  seqlock_atomic<int> atomic_int{5};
+  BOOST_CHECK_EQUAL(atomic_int.peek(), 5);
+
+  atomic_int.push(7);
+  BOOST_CHECK_EQUAL(atomic_int.peek(), 7);
+
+  const auto& const_atomic_int = atomic_int;
+  BOOST_CHECK_EQUAL(14, const_atomic_int.apply([](const int& ii) {
+    return ii * 2;
+  }));
+  BOOST_CHECK_EQUAL(7, atomic_int.peek());
+
+  auto ret = atomic_int.apply([](int& ii) { return ++ii; });
+  BOOST_CHECK_EQUAL(8, ret);
+  BOOST_CHECK_EQUAL(8, atomic_int.peek());
+
+  atomic_int.apply([](int& ii) { ii = 1; });
+  BOOST_CHECK_EQUAL(1, atomic_int.peek());
+
+  seqlock_atomic<Telemetry> telemetry;
+  BOOST_CHECK_EQUAL(telemetry.peek().a, 0);
+  telemetry.push(Telemetry{1, 2, 3.0, {}});
+  BOOST_CHECK_EQUAL(telemetry.peek().b, 2);
+  BOOST_CHECK_EQUAL(telemetry.peek().c, 3.0);
+}
+
+BOOST_AUTO_TEST_CASE(NoTornReadsTest) {
+  seqlock_atomic<Telemetry> telemetry;
+  const auto num_writes = 20000;
+  std::atomic<bool> done{false};
+
+  auto writer = std::async(std::launch::async, [&]() {
+    for (int ii{1}; ii <= num_writes; ii++) {
+      if (ii % 2 == 0) {
+        Telemetry t{ii, ii, static_cast<double>(ii), {}};
+        t.d.fill(ii);
+        telemetry.push(t);
+      } else {
+        telemetry.apply([ii](Telemetry& t) {
+          t = {ii, ii, static_cast<double>(ii), {}};
+          t.d.fill(ii);
+        });
+      }
+    }
+    done = true;
+  });
+
+  auto reader = [&]() {
+    int last = 0;
+    while (!done) {
+      const auto t = telemetry.peek();
+      if (t.a != t.b || t.c != t.a ||
+          std::any_of(t.d.cbegin(), t.d.cend(),
+                      [&t](long v) { return v != t.a; })) {
+        return false;
+      }
+      if (t.a < last) {
+        return false;
+      }
+      last = t.a;
+    }
+    return true;
+  };
+
+  auto r1 = std::async(std::launch::async, reader);
+  auto r2 = std::async(std::launch::async, reader);
+  auto r3 = std::async(std::launch::async, reader);
+
+  writer.get();
+  BOOST_CHECK(r1.get());
+  BOOST_CHECK(r2.get());
+  BOOST_CHECK(r3.get());
+  BOOST_CHECK_EQUAL(telemetry.peek().a, num_writes);
+}
+
+BOOST_AUTO_TEST_CASE(MultithreadedWriteTest) {
+  seqlock_atomic<long> counter{0};
+  const auto per_thread = 10000;
+
+  auto func = [&]() {
+    for (int ii{0}; ii < per_thread; ii++) {
+      counter.apply([](long& c) { c++; });
+    }
+  };
+
+  auto f1 = std::async(std::launch::async, func);
+  auto f2 = std::async(std::launch::async, func);
+  auto f3 = std::async(std::launch::async, func);
+  auto f4 = std::async(std::launch::async, func);
+
+  f1.get();
+  f2.get();
+  f3.get();
+  f4.get();
+
+  BOOST_CHECK_EQUAL(counter.peek(), 4 * per_thread);
+}
@@ -0,0 +1,164 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE spsc_queue_test
+
+#include "async/spsc_queue.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <future>
+#include <iterator>
+#include <meta/none_such.hpp>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace nil;
+using namespace nil::async;
+
+BOOST_AUTO_TEST_CASE(PushPopTest) {
+  spsc_queue<std::string> q{3};
+  BOOST_CHECK_EQUAL(q.capacity(), 4u);
+  BOOST_CHECK(q.empty());
+  BOOST_CHECK(q.try_pop() == std::nullopt);
+
+  const std::string str{"1"};
+  BOOST_CHECK(q.try_push(str));
+  BOOST_CHECK(q.try_push(std::string{"2"}));
+  BOOST_CHECK(q.try_push("3"));
+  BOOST_CHECK(q.try_emplace(1, '4'));
+  BOOST_CHECK(!q.try_push("5"));
+  BOOST_CHECK_EQUAL(q.size(), 4u);
+
+  BOOST_CHECK_EQUAL(q.try_pop().value(), "1");
+  BOOST_CHECK(q.try_push("5"));
+  BOOST_CHECK_EQUAL(q.try_pop().value(), "2");
+  BOOST_CHECK_EQUAL(q.try_pop().value(), "3");
+  BOOST_CHECK_EQUAL(q.try_pop().value(), "4");
+  BOOST_CHECK_EQUAL(q.try_pop().value(), "5");
+  BOOST_CHECK(q.try_pop() == std::nullopt);
+}
+
+BOOST_AUTO_TEST_CASE(BulkTest) {
+  spsc_queue<int> q{8};
+  std::vector<int> in(10);
+  std::iota(in.begin(), in.end(), 0);
+
+  BOOST_CHECK_EQUAL(q.push_n(in.cbegin(), 5), 5u);
+  BOOST_CHECK_EQUAL(q.push_n(in.cbegin() + 5, 5), 3u);  // full after 8
+  BOOST_CHECK_EQUAL(q.size(), 8u);
+
+  std::vector<int> out;
+  BOOST_CHECK_EQUAL(q.pop_n(std::back_inserter(out), 6), 6u);
+  BOOST_CHECK_EQUAL(q.push_n(in.cbegin() + 8, 2), 2u);
+  BOOST_CHECK_EQUAL(q.pop_n(std::back_inserter(out), 100), 4u);
+  BOOST_CHECK(q.empty());
+  BOOST_CHECK(out == in);
+}
+
+BOOST_AUTO_TEST_CASE(BulkThrowTest) {
+  // an output iterator that throws instead of taking its third element
+  struct throwing_out {
+    std::vector<std::string>* taken;
+
+    throwing_out& operator*() { return *this; }
+    throwing_out& operator++() { return *this; }
+    throwing_out& operator=(std::string&& s) {
+      if (taken->size() == 2) {
+        throw std::runtime_error("full");
+      }
+      taken->push_back(std::move(s));
+      return *this;
+    }
+  };
+
+  spsc_queue<std::string> q{8};
+  const std::vector<std::string> in{"a", "b", "c", "d"};
+  BOOST_CHECK_EQUAL(q.push_n(in.cbegin(), 4), 4u);
+
+  std::vector<std::string> out;
+  BOOST_CHECK_THROW(q.pop_n(throwing_out{&out}, 4), std::runtime_error);
+  BOOST_CHECK((out == std::vector<std::string>{"a", "b"}));
+
+  // the element that threw and everything after it are still queued
+  BOOST_CHECK_EQUAL(q.size(), 2u);
+  BOOST_CHECK_EQUAL(q.try_pop().value(), "c");
+  BOOST_CHECK_EQUAL(q.pop_n(std::back_inserter(out), 4), 1u);
+  BOOST_CHECK_EQUAL(out.back(), "d");
+  BOOST_CHECK(q.empty());
+}
+
+BOOST_AUTO_TEST_CASE(MoveOnlyTest) {
+  spsc_queue<std::unique_ptr<int>> q{4};
+  BOOST_CHECK(q.try_push(std::make_unique<int>(1)));
+
+  std::vector<std::unique_ptr<int>> in;
+  in.push_back(std::make_unique<int>(2));
+  in.push_back(std::make_unique<int>(3));
+  BOOST_CHECK_EQUAL(q.push_n(std::make_move_iterator(in.begin()), 2), 2u);
+
+  std::vector<std::unique_ptr<int>> out;
+  BOOST_CHECK_EQUAL(q.pop_n(std::back_inserter(out), 3), 3u);
+  BOOST_CHECK_EQUAL(*out[0], 1);
+  BOOST_CHECK_EQUAL(*out[2], 3);
+
+  spsc_queue<MoveOnly> q2{2};
+  BOOST_CHECK(q2.try_push(MoveOnly{}));
+  BOOST_CHECK(q2.try_pop() != std::nullopt);
+}
+
+BOOST_AUTO_TEST_CASE(DestructorTest) {
+  auto counter = std::make_shared<int>(0);
+  {
+    spsc_queue<std::shared_ptr<int>> q{8};
+    for (int ii{0}; ii < 5; ii++) {
+      q.try_push(counter);
+    }
+    q.try_pop();
+    BOOST_CHECK_EQUAL(counter.use_count(), 5);
+  }
+  BOOST_CHECK_EQUAL(counter.use_count(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(MultithreadedTest) {
+  spsc_queue<int> q{64};
+  const int num_elements = 100000;
+
+  auto producer = std::async(std::launch::async, [&]() {
+    int next = 0;
+    std::vector<int> batch(16);
+    while (next < num_elements) {
+      if (next % 3 == 0) {
+        if (q.try_push(next)) {
+          next++;
+        }
+      } else {
+        const auto n = std::min<int>(16, num_elements - next);
+        std::iota(batch.begin(), batch.begin() + n, next);
+        next += q.push_n(batch.cbegin(), n);
+      }
+      std::this_thread::yield();
+    }
+  });
+
+  auto consumer = std::async(std::launch::async, [&]() {
+    std::vector<int> out;
+    while (out.size() < num_elements) {
+      if (out.size() % 2 == 0) {
+        if (auto v = q.try_pop()) {
+          out.push_back(*v);
+        }
+      } else {
+        q.pop_n(std::back_inserter(out), 7);
+      }
+      std::this_thread::yield();
+    }
+    return out;
+  });
+
+  producer.get();
+  const auto out = consumer.get();
+  BOOST_CHECK_EQUAL(out.size(), num_elements);
+  for (int ii{0}; ii < num_elements; ii++) {
+    BOOST_REQUIRE_EQUAL(out[ii], ii);
+  }
+}
@@ -0,0 +1,95 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE strand_test
+
+#include "async/strand.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace nil::async;
+
+BOOST_AUTO_TEST_CASE(PostSubmitTest) {
+  strand<std::string> str{"hello"};
+
+  str.post([](std::string& s) { s += " world"; });
+  BOOST_CHECK_EQUAL(str.submit([](const std::string& s) { return s; }).get(),
+                    "hello world");
+
+  // callables passed as lvalues are copied
+  const auto exclaim = [](std::string& s) { s += "!"; };
+  str.post(exclaim);
+  BOOST_CHECK_EQUAL(str.submit([](const std::string& s) { return s; }).get(),
+                    "hello world!");
+
+  auto done = str.submit([](std::string& s) { s.clear(); });
+  done.get();
+  BOOST_CHECK(str.submit([](const std::string& s) { return s.empty(); }).get());
+}
+
+BOOST_AUTO_TEST_CASE(ExceptionTest) {
+  strand<int> value{1};
+  auto failed =
+      value.submit([](int&) -> int { throw std::runtime_error("oops"); });
+  BOOST_CHECK_THROW(failed.get(), std::runtime_error);
+
+  // the strand carries on after a failed submit
+  BOOST_CHECK_EQUAL(value.submit([](int& v) { return ++v; }).get(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(MoveOnlyTest) {
+  strand<std::vector<std::unique_ptr<int>>> owned;
+  auto ptr = std::make_unique<int>(3);
+  owned.post([p = std::move(ptr)](auto& v) mutable {
+    v.push_back(std::move(p));
+  });
+  BOOST_CHECK_EQUAL(owned.submit([](auto& v) { return *v.at(0); }).get(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(NestedPostTest) {
+  strand<std::vector<int>> order;
+  order.post([&order](std::vector<int>& v) {
+    v.push_back(1);
+    // queued behind the current callable, not run inside it
+    order.post([](std::vector<int>& inner) { inner.push_back(3); });
+    v.push_back(2);
+  });
+  BOOST_CHECK(order.submit([](const auto& v) { return v; }).get() ==
+              (std::vector<int>{1, 2, 3}));
+}
+
+BOOST_AUTO_TEST_CASE(MultithreadedTest) {
+  struct counts {
+    long total{0};                // deliberately not atomic
+    std::vector<int> last_seen;  // per producer, to check ordering
+    bool ordered{true};
+  };
+  const int producers = 8;
+  const int per_thread = 10000;
+  strand<counts> state;
+  state.post([](counts& c) { c.last_seen.assign(producers, -1); });
+
+  std::vector<std::future<void>> futures;
+  for (int tt{0}; tt < producers; tt++) {
+    futures.push_back(std::async(std::launch::async, [&state, tt]() {
+      for (int ii{0}; ii < per_thread; ii++) {
+        state.post([tt, ii](counts& c) {
+          c.total++;
+          c.ordered = c.ordered && c.last_seen[tt] < ii;
+          c.last_seen[tt] = ii;
+        });
+      }
+    }));
+  }
+  for (auto& f : futures) {
+    f.get();
+  }
+
+  // every post has returned, so every callable has run
+  BOOST_CHECK_EQUAL(state.submit([](const counts& c) { return c.total; }).get(),
+                    long{producers} * per_thread);
+  BOOST_CHECK(state.submit([](const counts& c) { return c.ordered; }).get());
+}
@@ -0,0 +1,164 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE thread_pool_test
+
+#include "async/thread_pool.hpp"
+
+#include <atomic>
+#include <boost/test/unit_test.hpp>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "async/work_stealing_deque.hpp"
+
+using namespace nil::async;
+
+BOOST_AUTO_TEST_CASE(DequeTest) {
+  work_stealing_deque<int> deque{2};
+  BOOST_CHECK(deque.empty());
+  BOOST_CHECK(!deque.pop());
+  BOOST_CHECK(!deque.steal());
+
+  // grows past the initial capacity
+  for (int ii{0}; ii < 100; ii++) {
+    deque.push(ii);
+  }
+  BOOST_CHECK_EQUAL(deque.size(), 100u);
+
+  // the owner pops the newest, thieves steal the oldest
+  BOOST_CHECK_EQUAL(*deque.pop(), 99);
+  BOOST_CHECK_EQUAL(*deque.steal(), 0);
+  BOOST_CHECK_EQUAL(*deque.steal(), 1);
+  BOOST_CHECK_EQUAL(*deque.pop(), 98);
+  BOOST_CHECK_EQUAL(deque.size(), 96u);
+}
+
+BOOST_AUTO_TEST_CASE(DequeStealTest) {
+  const int count = 100000;
+  const int thieves = 3;
+  work_stealing_deque<int> deque;
+  std::vector<std::atomic<int>> taken(count);
+  std::atomic<bool> done{false};
+
+  std::vector<std::future<void>> futures;
+  for (int tt{0}; tt < thieves; tt++) {
+    futures.push_back(std::async(std::launch::async, [&]() {
+      while (!done.load() || !deque.empty()) {
+        if (auto v = deque.steal()) {
+          taken[*v]++;
+        }
+      }
+    }));
+  }
+
+  // the owner pops every other push, racing the thieves for the last element
+  for (int ii{0}; ii < count; ii++) {
+    deque.push(ii);
+    if (ii % 2 == 1) {
+      if (auto v = deque.pop()) {
+        taken[*v]++;
+      }
+    }
+  }
+  while (auto v = deque.pop()) {
+    taken[*v]++;
+  }
+  done = true;
+  for (auto& f : futures) {
+    f.get();
+  }
+
+  // every element was taken exactly once
+  int wrong{0};
+  for (const auto& t : taken) {
+    wrong += t.load() != 1;
+  }
+  BOOST_CHECK_EQUAL(wrong, 0);
+}
+
+BOOST_AUTO_TEST_CASE(SubmitTest) {
+  thread_pool pool{2};
+  BOOST_CHECK_EQUAL(pool.size(), 2u);
+
+  BOOST_CHECK_EQUAL(pool.submit([]() { return std::string{"hi"}; }).get(),
+                    "hi");
+
+  auto ptr = std::make_unique<int>(3);
+  BOOST_CHECK_EQUAL(pool.submit([p = std::move(ptr)]() { return *p; }).get(),
+                    3);
+
+  auto failed = pool.submit([]() -> int { throw std::runtime_error("oops"); });
+  BOOST_CHECK_THROW(failed.get(), std::runtime_error);
+
+  int value{0};
+  pool.submit([&value]() { value = 1; }).get();
+  BOOST_CHECK_EQUAL(value, 1);
+}
+
+BOOST_AUTO_TEST_CASE(NestedPostTest) {
+  std::atomic<int> leaves{0};
+  {
+    thread_pool pool{4};
+
+    // fans out from inside tasks, onto the workers' own deques
+    struct fan_out {
+      thread_pool& pool;
+      std::atomic<int>& leaves;
+      int depth;
+
+      void operator()() const {
+        if (depth == 0) {
+          leaves++;
+          return;
+        }
+        pool.post(fan_out{pool, leaves, depth - 1});
+        pool.post(fan_out{pool, leaves, depth - 1});
+      }
+    };
+    pool.post(fan_out{pool, leaves, 12});
+  }
+  // the destructor ran everything, including what tasks posted
+  BOOST_CHECK_EQUAL(leaves.load(), 1 << 12);
+}
+
+BOOST_AUTO_TEST_CASE(ManyPostersTest) {
+  const int posters = 4;
+  const int per_thread = 10000;
+  std::atomic<long> total{0};
+  {
+    thread_pool pool{3, true};
+    std::vector<std::future<void>> futures;
+    for (int tt{0}; tt < posters; tt++) {
+      futures.push_back(std::async(std::launch::async, [&]() {
+        for (int ii{0}; ii < per_thread; ii++) {
+          pool.post([&total, ii]() { total += ii; });
+        }
+      }));
+    }
+    for (auto& f : futures) {
+      f.get();
+    }
+  }
+  BOOST_CHECK_EQUAL(total.load(),
+                    long{posters} * per_thread * (per_thread - 1) / 2);
+}
+
+BOOST_AUTO_TEST_CASE(IdleTest) {
+  thread_pool pool{4};
+
+  // workers park between bursts, and wake up for the next one
+  for (int burst{0}; burst < 20; burst++) {
+    std::vector<std::future<int>> results;
+    for (int ii{0}; ii < 8; ii++) {
+      results.push_back(pool.submit([ii]() { return ii; }));
+    }
+    int sum{0};
+    for (auto& r : results) {
+      sum += r.get();
+    }
+    BOOST_REQUIRE_EQUAL(sum, 28);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
@@ -0,0 +1,133 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE unordered_map_test
+
+#include "async/unordered_map.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <future>
+#include <memory>
+#include <meta/none_such.hpp>
+#include <string>
+
+using namespace nil;
+using namespace nil::async;
+
+BOOST_AUTO_TEST_CASE(ShardCountTest) {
+  BOOST_CHECK_EQUAL((unordered_map<int, int>{}.shard_count()),
+                    (unordered_map<int, int>::default_shard_count));
+  BOOST_CHECK_EQUAL((unordered_map<int, int>{0}.shard_count()), 1u);
+  BOOST_CHECK_EQUAL((unordered_map<int, int>{1}.shard_count()), 1u);
+  BOOST_CHECK_EQUAL((unordered_map<int, int>{5}.shard_count()), 8u);
+  BOOST_CHECK_EQUAL((unordered_map<int, int>{64}.shard_count()), 64u);
+}
+
+BOOST_AUTO_TEST_CASE(InsertFindEraseTest) {
+  unordered_map<std::string, int> map;
+  BOOST_CHECK(map.empty());
+  BOOST_CHECK(map.find("a") == std::nullopt);
+  BOOST_CHECK(!map.contains("a"));
+
+  BOOST_CHECK(map.insert("a", 1));
+  BOOST_CHECK(!map.insert("a", 2));
+  BOOST_CHECK_EQUAL(map.find("a").value(), 1);
+
+  BOOST_CHECK(!map.insert_or_assign("a", 3));
+  BOOST_CHECK_EQUAL(map.find("a").value(), 3);
+  BOOST_CHECK(map.insert_or_assign(std::string{"b"}, 4));
+  BOOST_CHECK(map.contains("b"));
+  BOOST_CHECK_EQUAL(map.size(), 2u);
+
+  BOOST_CHECK_EQUAL(map.erase("a"), 1u);
+  BOOST_CHECK_EQUAL(map.erase("a"), 0u);
+  BOOST_CHECK_EQUAL(map.extract("b").value(), 4);
+  BOOST_CHECK(map.extract("b") == std::nullopt);
+  BOOST_CHECK(map.empty());
+}
+
+BOOST_AUTO_TEST_CASE(ApplyTest) {
+  unordered_map<int, std::string> map;
+
+  // default constructs missing values, like operator[]
+  const auto size = map.apply(1, [](std::string& s) {
+    s += "one";
+    return s.size();
+  });
+  BOOST_CHECK_EQUAL(size, 3u);
+  BOOST_CHECK_EQUAL(map.find(1).value(), "one");
+
+  BOOST_CHECK(!map.apply_if(2, [](std::string& s) { s = "two"; }));
+  BOOST_CHECK(!map.contains(2));
+  BOOST_CHECK(map.apply_if(1, [](std::string& s) { s = "uno"; }));
+
+  std::string copy;
+  const auto& cmap = map;
+  BOOST_CHECK(cmap.apply_if(1, [&copy](const std::string& s) { copy = s; }));
+  BOOST_CHECK_EQUAL(copy, "uno");
+}
+
+BOOST_AUTO_TEST_CASE(ForEachClearTest) {
+  unordered_map<int, int> map{4};
+  for (int ii{0}; ii < 100; ii++) {
+    map.insert(ii, ii);
+  }
+
+  map.for_each([](const int&, int& v) { v *= 2; });
+
+  int sum{0};
+  std::size_t count{0};
+  map.for_each([&](const int& k, const int& v) {
+    BOOST_CHECK_EQUAL(v, k * 2);
+    sum += v;
+    count++;
+  });
+  BOOST_CHECK_EQUAL(count, 100u);
+  BOOST_CHECK_EQUAL(sum, 99 * 100);
+
+  map.clear();
+  BOOST_CHECK(map.empty());
+}
+
+BOOST_AUTO_TEST_CASE(MoveOnlyTest) {
+  unordered_map<int, std::unique_ptr<int>> map;
+  BOOST_CHECK(map.insert(1, std::make_unique<int>(7)));
+  BOOST_CHECK(map.apply_if(1, [](const std::unique_ptr<int>& p) {
+    BOOST_CHECK_EQUAL(*p, 7);
+  }));
+  BOOST_CHECK_EQUAL(*map.extract(1).value(), 7);
+
+  unordered_map<int, MoveOnly> move_only;
+  BOOST_CHECK(move_only.insert_or_assign(1, MoveOnly{}));
+  BOOST_CHECK(move_only.extract(1).has_value());
+}
+
+BOOST_AUTO_TEST_CASE(MultithreadTest) {
+  unordered_map<int, int> map;
+  const int keys = 64;
+  const int per_thread = 10000;
+
+  auto func = [&](int tid) {
+    for (int ii{0}; ii < per_thread; ii++) {
+      map.apply(ii % keys, [](int& v) { v++; });
+      map.insert_or_assign(keys + tid, ii);
+      map.find(ii % keys);
+    }
+  };
+
+  std::vector<std::future<void>> futures;
+  for (int tt{0}; tt < 4; tt++) {
+    futures.push_back(std::async(std::launch::async, func, tt));
+  }
+  for (auto& f : futures) {
+    f.get();
+  }
+
+  int total{0};
+  for (int ii{0}; ii < keys; ii++) {
+    total += map.find(ii).value();
+  }
+  BOOST_CHECK_EQUAL(total, 4 * per_thread);
+  BOOST_CHECK_EQUAL(map.size(), static_cast<std::size_t>(keys + 4));
+  for (int tt{0}; tt < 4; tt++) {
+    BOOST_CHECK_EQUAL(map.find(keys + tt).value(), per_thread - 1);
+  }
+}